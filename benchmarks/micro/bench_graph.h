@@ -0,0 +1,103 @@
+#ifndef GEMPP_BENCH_GRAPH_H
+#define GEMPP_BENCH_GRAPH_H
+
+#include "bench_util.h"
+#include "legacy_graph.h"
+#include "model/graph.h"
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gempp {
+namespace bench {
+
+inline legacy::Graph* buildLegacyGraph(int n, const std::vector<std::pair<int, int>>& arcs) {
+    legacy::Graph* g = new legacy::Graph(legacy::Graph::DIRECTED);
+    for (int i = 0; i < n; ++i) {
+        g->addVertex(new legacy::Vertex(), std::to_string(i));
+    }
+    for (const auto& a : arcs) {
+        legacy::Edge* e = new legacy::Edge();
+        e->setOrigin(g->getVertex(a.first));
+        e->setTarget(g->getVertex(a.second));
+        g->addEdge(e);
+        g->getVertex(a.first)->addEdge(e, legacy::Vertex::EDGE_OUT);
+        g->getVertex(a.second)->addEdge(e, legacy::Vertex::EDGE_IN);
+    }
+    return g;
+}
+
+inline Graph* buildCompactGraph(int n, const std::vector<std::pair<int, int>>& arcs) {
+    Graph::Builder builder(n);
+    for (const auto& a : arcs) {
+        builder.addEdges(a.first, a.second);
+    }
+    return builder.build();
+}
+
+// Visits every (vertex, out-neighbour) and (vertex, in-neighbour) pair
+inline int64_t traverseLegacy(const legacy::Graph* g) {
+    int64_t sum = 0;
+    for (legacy::Vertex* v : g->getVertices()) {
+        for (legacy::Edge* e : v->getEdges(legacy::Vertex::EDGE_OUT)) sum += e->getTarget()->getIndex();
+        for (legacy::Edge* e : v->getEdges(legacy::Vertex::EDGE_IN)) sum += e->getOrigin()->getIndex();
+    }
+    return sum;
+}
+
+inline int64_t traverseCompact(const Graph* g) {
+    int64_t sum = 0;
+    for (int v = 0; v < g->getVertexCount(); ++v) {
+        for (int w : g->getOutNeighbors(v)) sum += w;
+        for (int e : g->getInEdges(v)) sum += g->getOrigin(e);
+    }
+    return sum;
+}
+
+// graph [n] [avg_out_degree]
+// Heap bytes and full-traversal time of the pointer-based model vs the CSR Graph
+// on a random directed graph.
+inline int benchGraph(int argc, char** argv) {
+    int n = argc > 0 ? std::stoi(argv[0]) : 50000;
+    int degree = argc > 1 ? std::stoi(argv[1]) : 8;
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    std::vector<std::pair<int, int>> arcs;
+    arcs.reserve(static_cast<size_t>(n) * degree);
+    for (int i = 0; i < n; ++i) {
+        for (int d = 0; d < degree; ++d) arcs.push_back({i, pick(rng)});
+    }
+
+    size_t base = allocatedBytes();
+    legacy::Graph* lg = buildLegacyGraph(n, arcs);
+    size_t legacyBytes = allocatedBytes() - base;
+
+    base = allocatedBytes();
+    Graph* cg = buildCompactGraph(n, arcs);
+    size_t compactBytes = allocatedBytes() - base;
+
+    int64_t sink = 0;
+    double legacyMs = bestOf(5, [&]() { sink += traverseLegacy(lg); });
+    double compactMs = bestOf(5, [&]() { sink += traverseCompact(cg); });
+
+    size_t m = arcs.size();
+    std::cout << "model,vertices,edges,heap_bytes,bytes_per_edge,traversal_ms" << std::endl;
+    std::cout << "pointer," << n << "," << m << "," << legacyBytes << ","
+              << static_cast<double>(legacyBytes) / m << "," << legacyMs << std::endl;
+    std::cout << "csr," << n << "," << m << "," << compactBytes << ","
+              << static_cast<double>(compactBytes) / m << "," << compactMs << std::endl;
+    std::cerr << "(checksum " << sink << ")" << std::endl;
+
+    delete lg;
+    delete cg;
+    return 0;
+}
+
+} // namespace bench
+} // namespace gempp
+
+#endif // GEMPP_BENCH_GRAPH_H
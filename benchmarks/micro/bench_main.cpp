@@ -0,0 +1,119 @@
+// Micro-benchmarks for gempp internals (parser, graph model, model building).
+// End-to-end CLI benchmarks live in scripts/benchmark*.sh.
+
+#include "bench_graph.h"
+#include "bench_matrix.h"
+#include "bench_parse.h"
+#include "core/types.h"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+using namespace gempp;
+
+// Heap accounting: every allocation carries a header with its size.
+// GCC cannot see that the replaced operator new below uses malloc, nor that the header
+// sits in front of the pointers it returns.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#endif
+static std::atomic<size_t> g_allocated(0);
+static constexpr size_t HEADER = alignof(std::max_align_t);
+
+void* operator new(size_t size) {
+    void* p = std::malloc(size + HEADER);
+    if (!p) throw std::bad_alloc();
+    *static_cast<size_t*>(p) = size;
+    g_allocated += size;
+    return static_cast<char*>(p) + HEADER;
+}
+
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    char* base = static_cast<char*>(p) - HEADER;
+    g_allocated -= *reinterpret_cast<size_t*>(base);
+    std::free(base);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+// Over-aligned allocations (Matrix buffers) use a header of `align` bytes
+void* operator new(size_t size, std::align_val_t align) {
+    size_t a = static_cast<size_t>(align);
+    void* p = std::aligned_alloc(a, (size + a + a - 1) / a * a);
+    if (!p) throw std::bad_alloc();
+    *static_cast<size_t*>(p) = size;
+    g_allocated += size;
+    return static_cast<char*>(p) + a;
+}
+
+void operator delete(void* p, std::align_val_t align) noexcept {
+    if (!p) return;
+    char* base = static_cast<char*>(p) - static_cast<size_t>(align);
+    g_allocated -= *reinterpret_cast<size_t*>(base);
+    std::free(base);
+}
+
+void operator delete(void* p, size_t, std::align_val_t align) noexcept {
+    operator delete(p, align);
+}
+
+size_t gempp::bench::allocatedBytes() {
+    return g_allocated.load();
+}
+
+static void printUsage(const char* exe) {
+    std::cerr << "Usage: " << exe << " <command> [args]" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "Commands:" << std::endl;
+    std::cerr << "  parse <file>...   Input parsing wall time (plain text or .gz)" << std::endl;
+    std::cerr << "  graph [n] [deg]   Memory and traversal: pointer-based vs CSR graph" << std::endl;
+    std::cerr << "  matrix [n]...     Fill and sweep: vector-of-vectors vs contiguous Matrix" << std::endl;
+    std::cerr << "  build [n] [deg]   Formulation build time and heap (minext and GED, no solving)" << std::endl;
+    std::cerr << "  build <file>...   Same, for the graph pairs of input files" << std::endl;
+    std::cerr << "  load [n] [deg] [stored|streamed]  GED model build into GLPK: time and peak RSS" << std::endl;
+    std::cerr << "  prune [n] [deg] [up]  Pruned GED relaxation: model size, build and solve time" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        std::string command = argv[1];
+        if (command == "parse") {
+            return bench::benchParse(argc - 2, argv + 2);
+        }
+        if (command == "graph") {
+            return bench::benchGraph(argc - 2, argv + 2);
+        }
+        if (command == "matrix") {
+            return bench::benchMatrix(argc - 2, argv + 2);
+        }
+        if (command == "build") {
+            return bench::benchBuild(argc - 2, argv + 2);
+        }
+        if (command == "load") {
+            return bench::benchLoad(argc - 2, argv + 2);
+        }
+        if (command == "prune") {
+            return bench::benchPrune(argc - 2, argv + 2);
+        }
+        std::cerr << "Error: unknown command '" << command << "'" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    } catch (const Exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Unexpected error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,218 @@
+#ifndef GEMPP_BENCH_MATRIX_H
+#define GEMPP_BENCH_MATRIX_H
+
+#include "bench_util.h"
+#include "legacy_matrix.h"
+#include "core/matrix.h"
+#include "core/resource_usage.h"
+#include "formulation/linear_ged.h"
+#include "formulation/mcsm.h"
+#include "model/adjacency_parser.h"
+#include "model/graph.h"
+#include "model/problem.h"
+#include "solver/glpk_solver.h"
+#include <cctype>
+#include <cmath>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace gempp {
+namespace bench {
+
+// Times (best of 5, ms) of building and filling an n x n matrix with setElement, then of
+// summing it with getElement row by row (the formulations' access order) and column by column
+struct SweepTimes {
+    double fill;
+    double rows;
+    double columns;
+};
+
+template <class M>
+inline SweepTimes sweepMatrix(int n, double& sink) {
+    SweepTimes t;
+    t.fill = bestOf(5, [&]() {
+        M m(n, n);
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) m.setElement(i, j, i + 0.5 * j);
+        }
+        sink += m.getElement(n - 1, n - 1);
+    });
+
+    M m(n, n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) m.setElement(i, j, i + 0.5 * j);
+    }
+    t.rows = bestOf(5, [&]() {
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) sink += m.getElement(i, j);
+        }
+    });
+    t.columns = bestOf(5, [&]() {
+        for (int j = 0; j < n; ++j) {
+            for (int i = 0; i < n; ++i) sink += m.getElement(i, j);
+        }
+    });
+    return t;
+}
+
+// matrix [n]...
+// Fill and sweep times of the vector-of-vectors matrix vs the contiguous Matrix.
+inline int benchMatrix(int argc, char** argv) {
+    std::vector<int> sizes;
+    for (int a = 0; a < argc; ++a) sizes.push_back(std::stoi(argv[a]));
+    if (sizes.empty()) sizes = {100, 300, 1000, 2000};
+
+    double sink = 0;
+    std::cout << "model,n,fill_ms,row_sweep_ms,column_sweep_ms" << std::endl;
+    for (int n : sizes) {
+        SweepTimes l = sweepMatrix<legacy::Matrix<double>>(n, sink);
+        SweepTimes c = sweepMatrix<Matrix<double>>(n, sink);
+        std::cout << "nested," << n << "," << l.fill << "," << l.rows << "," << l.columns << std::endl;
+        std::cout << "contiguous," << n << "," << c.fill << "," << c.rows << "," << c.columns
+                  << std::endl;
+    }
+    std::cerr << "(checksum " << sink << ")" << std::endl;
+    return 0;
+}
+
+inline Graph* randomGraph(int n, int degree, std::mt19937& rng) {
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    Graph::Builder builder(n);
+    for (int i = 0; i < n; ++i) {
+        for (int d = 0; d < degree; ++d) builder.addEdges(i, pick(rng));
+    }
+    return builder.build();
+}
+
+// Prints "<input>,<formulation>,<pattern_edges>,<target_edges>,<build_ms>,<heap_bytes>" for the
+// minext and GED formulations: build time (Problem + init, no solving, best of 3) and the
+// live heap held by the built model
+inline void benchBuildPair(const std::string& input, Graph* pattern, Graph* target) {
+    size_t mcsmBytes = 0;
+    size_t gedBytes = 0;
+    double mcsmMs = bestOf(3, [&]() {
+        size_t base = allocatedBytes();
+        Problem problem(Problem::SUBGRAPH, pattern, target);
+        MinimumCostSubgraphMatching formulation(&problem, false);
+        formulation.init();
+        mcsmBytes = allocatedBytes() - base;
+    });
+    double gedMs = bestOf(3, [&]() {
+        size_t base = allocatedBytes();
+        Problem problem(Problem::GED, pattern, target);
+        LinearGraphEditDistance formulation(&problem);
+        formulation.init();
+        gedBytes = allocatedBytes() - base;
+    });
+
+    std::string edges = std::to_string(pattern->getEdgeCount()) + "," +
+                        std::to_string(target->getEdgeCount());
+    std::cout << input << ",minext," << edges << "," << mcsmMs << "," << mcsmBytes << std::endl;
+    std::cout << input << ",ged," << edges << "," << gedMs << "," << gedBytes << std::endl;
+}
+
+// build [n] [deg] | build <file>...
+// Formulation build time and model heap for random n-vertex pattern and target graphs, or
+// for the graph pairs of the given input files.
+inline int benchBuild(int argc, char** argv) {
+    std::cout << "input,formulation,pattern_edges,target_edges,build_ms,heap_bytes" << std::endl;
+    if (argc > 0 && !std::isdigit(static_cast<unsigned char>(argv[0][0]))) {
+        for (int a = 0; a < argc; ++a) {
+            auto graphs = AdjacencyMatrixParser::parseFile(argv[a]);
+            benchBuildPair(argv[a], graphs.first, graphs.second);
+            delete graphs.first;
+            delete graphs.second;
+        }
+        return 0;
+    }
+
+    int n = argc > 0 ? std::stoi(argv[0]) : 100;
+    int degree = argc > 1 ? std::stoi(argv[1]) : 2;
+
+    std::mt19937 rng(42);
+    Graph* pattern = randomGraph(n, degree, rng);
+    Graph* target = randomGraph(n, degree, rng);
+    benchBuildPair("random" + std::to_string(n), pattern, target);
+    delete pattern;
+    delete target;
+    return 0;
+}
+
+// load [n] [deg] [stored|streamed]
+// GED model built into GLPK for random n-vertex graphs, either stored in the LinearProgram
+// and loaded by GLPKSolver::init, or streamed into GLPK as rows are closed. Peak RSS is
+// process-wide, so run one mode per process.
+inline int benchLoad(int argc, char** argv) {
+    int n = argc > 0 ? std::stoi(argv[0]) : 100;
+    int degree = argc > 1 ? std::stoi(argv[1]) : 2;
+    std::string mode = argc > 2 ? argv[2] : "streamed";
+    if (mode != "stored" && mode != "streamed") {
+        throw Exception("load mode must be 'stored' or 'streamed'");
+    }
+
+    std::mt19937 rng(42);
+    Graph* pattern = randomGraph(n, degree, rng);
+    Graph* target = randomGraph(n, degree, rng);
+
+    auto start = std::chrono::steady_clock::now();
+    Problem problem(Problem::GED, pattern, target);
+    LinearGraphEditDistance formulation(&problem);
+    GLPKSolver solver;
+    formulation.init(1.0, false, mode == "streamed" ? &solver : nullptr);
+    solver.init(formulation.getLinearProgram());
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                    .count();
+
+    std::cout << "mode,vertices,rows,nonzeros,load_ms,peak_rss_bytes" << std::endl;
+    std::cout << mode << "," << n << "," << formulation.getLinearProgram()->getConstraintCount()
+              << "," << formulation.getLinearProgram()->getConstraints().getNonZeroCount() << ","
+              << ms << "," << peakResidentBytes() << std::endl;
+    delete pattern;
+    delete target;
+    return 0;
+}
+
+// prune [n] [deg] [up]
+// GED F2 relaxation for random n-vertex graphs with degree-difference vertex substitution
+// costs, pruned with --up: size of the model handed to GLPK, build and solve time.
+inline int benchPrune(int argc, char** argv) {
+    int n = argc > 0 ? std::stoi(argv[0]) : 30;
+    int degree = argc > 1 ? std::stoi(argv[1]) : 2;
+    double up = argc > 2 ? std::stod(argv[2]) : 0.2;
+
+    std::mt19937 rng(42);
+    Graph* pattern = randomGraph(n, degree, rng);
+    Graph* target = randomGraph(n, degree, rng);
+
+    auto start = std::chrono::steady_clock::now();
+    Problem problem(Problem::GED, pattern, target);
+    problem.setCostFunction(true, [pattern, target](int i, int k) {
+        return std::abs(pattern->getDegree(i) - target->getDegree(k)) * 0.5;
+    });
+    LinearGraphEditDistance formulation(&problem);
+    GLPKSolver solver;
+    formulation.init(up, true, &solver);
+    solver.init(formulation.getLinearProgram(), false, true);
+    auto built = std::chrono::steady_clock::now();
+    std::vector<double> values;
+    double objective = solver.solve(values);
+    auto solved = std::chrono::steady_clock::now();
+
+    std::cout << "vertices,up,rows,columns,nonzeros,build_ms,solve_ms,objective" << std::endl;
+    std::cout << n << "," << up << "," << solver.getRowCount() << "," << solver.getColumnCount()
+              << "," << solver.getNonZeroCount() << ","
+              << std::chrono::duration<double, std::milli>(built - start).count() << ","
+              << std::chrono::duration<double, std::milli>(solved - built).count() << ","
+              << objective << std::endl;
+    delete pattern;
+    delete target;
+    return 0;
+}
+
+} // namespace bench
+} // namespace gempp
+
+#endif // GEMPP_BENCH_MATRIX_H
@@ -0,0 +1,40 @@
+#ifndef GEMPP_BENCH_PARSE_H
+#define GEMPP_BENCH_PARSE_H
+
+#include "bench_util.h"
+#include "model/adjacency_parser.h"
+#include <iostream>
+#include <string>
+
+namespace gempp {
+namespace bench {
+
+// parse <file>...
+// Prints "file,vertices,edges,parse_ms" (best of 3) for each input file.
+inline int benchParse(int argc, char** argv) {
+    if (argc < 1) {
+        std::cerr << "Usage: gempp_bench parse <file>..." << std::endl;
+        return 1;
+    }
+
+    std::cout << "file,pattern_vertices,target_vertices,target_edges,parse_ms" << std::endl;
+    for (int a = 0; a < argc; ++a) {
+        std::string file = argv[a];
+        int nVP = 0, nVT = 0, nET = 0;
+        double ms = bestOf(3, [&]() {
+            auto graphs = AdjacencyMatrixParser::parseFile(file);
+            nVP = graphs.first->getVertexCount();
+            nVT = graphs.second->getVertexCount();
+            nET = graphs.second->getEdgeCount();
+            delete graphs.first;
+            delete graphs.second;
+        });
+        std::cout << file << "," << nVP << "," << nVT << "," << nET << "," << ms << std::endl;
+    }
+    return 0;
+}
+
+} // namespace bench
+} // namespace gempp
+
+#endif // GEMPP_BENCH_PARSE_H
@@ -0,0 +1,31 @@
+#ifndef GEMPP_BENCH_UTIL_H
+#define GEMPP_BENCH_UTIL_H
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <limits>
+
+namespace gempp {
+namespace bench {
+
+// Live heap bytes allocated through operator new (counted in bench_main.cpp)
+size_t allocatedBytes();
+
+// Best-of-N wall time of fn() in milliseconds
+inline double bestOf(int repeats, const std::function<void()>& fn) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        if (ms < best) best = ms;
+    }
+    return best;
+}
+
+} // namespace bench
+} // namespace gempp
+
+#endif // GEMPP_BENCH_UTIL_H
@@ -0,0 +1,48 @@
+#ifndef GEMPP_BENCH_LEGACY_MATRIX_H
+#define GEMPP_BENCH_LEGACY_MATRIX_H
+
+#include <vector>
+
+// Vector-of-vectors matrix used before the contiguous Matrix (src/core/matrix.h).
+// Kept only as the baseline for `gempp_bench matrix`.
+namespace gempp {
+namespace legacy {
+
+template <class T>
+class Matrix {
+public:
+    Matrix() : rows_(0), cols_(0) {}
+
+    Matrix(int rows, int cols, T init = T()) : rows_(rows), cols_(cols) {
+        matrix_.resize(rows);
+        for (int i = 0; i < rows; ++i) {
+            matrix_[i].resize(cols, init);
+        }
+    }
+
+    int getRowsNumber() const { return rows_; }
+    int getColumnsNumber() const { return cols_; }
+
+    T getElement(int i, int j) const {
+        if (i >= 0 && i < rows_ && j >= 0 && j < cols_) {
+            return matrix_[i][j];
+        }
+        return T();
+    }
+
+    void setElement(int i, int j, T value) {
+        if (i >= 0 && i < rows_ && j >= 0 && j < cols_) {
+            matrix_[i][j] = value;
+        }
+    }
+
+private:
+    int rows_;
+    int cols_;
+    std::vector<std::vector<T>> matrix_;
+};
+
+} // namespace legacy
+} // namespace gempp
+
+#endif // GEMPP_BENCH_LEGACY_MATRIX_H
@@ -0,0 +1,118 @@
+#!/bin/bash
+# Benchmark script for gempp - bipartite GED bounds (--bipartite) against the exact GED
+# Usage: ./scripts/benchmark_bipartite.sh [exact_timeout_seconds]
+# Exact runs (--mcs) are stopped after exact_timeout_seconds (default 60) and reported as "timeout"
+
+set -e
+
+EXACT_TIMEOUT=${1:-60}
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/build"
+BENCHMARKS_DIR="$PROJECT_DIR/benchmarks"
+EXE="$PROJECT_DIR/gempp"
+RESULTS_FILE="$BENCHMARKS_DIR/results_bipartite.csv"
+
+echo "=== Building gempp ==="
+mkdir -p "$BUILD_DIR"
+cd "$BUILD_DIR"
+cmake .. >/dev/null
+cmake --build . --parallel >/dev/null
+cd "$PROJECT_DIR"
+
+if [ ! -f "$EXE" ]; then
+    echo "Build failed: executable not found"
+    exit 1
+fi
+
+mkdir -p "$BENCHMARKS_DIR"
+
+# Random undirected graph with n vertices and n * degree / 2 edges (edge list, both arcs of
+# each edge), followed by the subgraph induced by a random keep fraction of its vertices,
+# relabelled: the pair printed is (subgraph, graph)
+generate_random_pair() {
+    local n=$1
+    local degree=$2
+    local keep=$3
+    local seed=$4
+    awk -v n=$n -v d=$degree -v keep=$keep -v seed=$seed 'BEGIN {
+        srand(seed)
+        m = int(n * d / 2); count = 0
+        while (count < m) {
+            a = int(rand() * n); b = int(rand() * n)
+            if (a == b) continue
+            if (a > b) { t = a; a = b; b = t }
+            if ((a "," b) in edge) continue
+            edge[a "," b] = 1; ea[count] = a; eb[count] = b; count++
+        }
+        for (v = 0; v < n; v++) perm[v] = v
+        for (v = n - 1; v > 0; v--) { w = int(rand() * (v + 1)); t = perm[v]; perm[v] = perm[w]; perm[w] = t }
+        k = int(n * keep)
+        for (v = 0; v < k; v++) label[perm[v]] = v
+        inner = 0
+        for (e = 0; e < m; e++) if ((ea[e] in label) && (eb[e] in label)) inner++
+        print k " edges " 2 * inner
+        for (e = 0; e < m; e++) if ((ea[e] in label) && (eb[e] in label)) {
+            print label[ea[e]] " " label[eb[e]]; print label[eb[e]] " " label[ea[e]]
+        }
+        print ""
+        print n " edges " 2 * m
+        for (e = 0; e < m; e++) { print ea[e] " " eb[e]; print eb[e] " " ea[e] }
+    }'
+}
+
+# Time (ms), GED and bound of one run ("-" if proven optimal), "timeout" if it did not finish
+run_ged() {
+    local limit=$1
+    shift
+    local output
+    if output=$(timeout "$limit" "$EXE" --ged --time "$@" 2>&1); then
+        local line=$(echo "$output" | grep "^GED:")
+        local bound=$(echo "$line" | sed -n 's/.*(bound \([0-9.]*\).*/\1/p')
+        echo "$(echo "$output" | grep "Time:" | awk '{print $2}') $(echo "$line" | awk '{print $2}') ${bound:--}"
+    else
+        echo "timeout - -"
+    fi
+}
+
+show_ms() {
+    if [ "$1" = "timeout" ]; then echo "timeout"; else echo "${1}ms"; fi
+}
+
+echo "=== Running bipartite GED benchmarks (exact timeout ${EXACT_TIMEOUT}s) ==="
+echo "Pattern Size,Target Size,Average Degree,Bipartite Time (ms),Upper Bound,Lower Bound,Exact Time (ms),Exact GED" > "$RESULTS_FILE"
+
+# Average degree, kept fraction, then target sizes; the exact GED is only attempted up to
+# exact_max vertices
+benchmark_family() {
+    local degree=$1
+    local keep=$2
+    local exact_max=$3
+    shift 3
+    for n in "$@"; do
+        local input_file="$BENCHMARKS_DIR/bipartite_n${n}_d${degree}.txt"
+        generate_random_pair $n $degree $keep $n > "$input_file"
+        local p=$(head -1 "$input_file" | awk '{print $1}')
+
+        read -r time_bp ged_bp bound_bp <<< "$(run_ged 600 --bipartite "$input_file")"
+        [ "$bound_bp" = "-" ] && bound_bp=$ged_bp
+        local time_exact="-" ged_exact="-"
+        if [ $n -le $exact_max ]; then
+            read -r time_exact ged_exact _ <<< "$(run_ged "$EXACT_TIMEOUT" --mcs "$input_file")"
+        fi
+
+        echo "G($p) in G($n), degree $degree: bipartite=$(show_ms $time_bp) (GED in [$bound_bp, $ged_bp]), exact=$([ "$time_exact" = "-" ] && echo "-" || show_ms $time_exact) (GED=$ged_exact)"
+        echo "$p,$n,$degree,$time_bp,$ged_bp,$bound_bp,$time_exact,$ged_exact" >> "$RESULTS_FILE"
+        rm -f "$input_file"
+    done
+}
+
+echo "--- Induced subgraphs (90% of the vertices), small ---"
+benchmark_family 3 0.9 20 10 12 14 16 20
+echo "--- Induced subgraphs (90% of the vertices), large ---"
+benchmark_family 6 0.9 0 100 1000 2000 5000 10000 20000
+
+echo ""
+echo "=== Bipartite benchmark complete ==="
+echo "Results saved to: $RESULTS_FILE"
@@ -0,0 +1,105 @@
+#!/bin/bash
+# Benchmark script for gempp - bit-parallel exact GED solver vs the ILP and --mcs
+# Usage: ./scripts/benchmark_bitset.sh [timeout_seconds]
+# Runs are stopped after timeout_seconds (default 60) and reported as "timeout"
+# Uses --ged, whose result is printed as plain text; the minimal extension solve dispatches
+# to the same solver
+
+set -e
+
+TIMEOUT=${1:-60}
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/build"
+BENCHMARKS_DIR="$PROJECT_DIR/benchmarks"
+EXE="$PROJECT_DIR/gempp"
+RESULTS_FILE="$BENCHMARKS_DIR/results_bitset.csv"
+
+echo "=== Building gempp ==="
+mkdir -p "$BUILD_DIR"
+cd "$BUILD_DIR"
+cmake .. >/dev/null
+cmake --build . --parallel >/dev/null
+cd "$PROJECT_DIR"
+
+if [ ! -f "$EXE" ]; then
+    echo "Build failed: executable not found"
+    exit 1
+fi
+
+mkdir -p "$BENCHMARKS_DIR"
+
+# Random undirected pattern with p vertices and target with t vertices, average degree d
+# (edge lists, both arcs of each edge)
+generate_random_pair() {
+    local p=$1
+    local t=$2
+    local degree=$3
+    local seed=$4
+    awk -v p=$p -v t=$t -v d=$degree -v seed=$seed '
+    function graph(n,    m, count, a, b, e, key) {
+        m = int(n * d / 2); count = 0
+        delete seen
+        print n " edges " 2 * m
+        while (count < m) {
+            a = int(rand() * n); b = int(rand() * n)
+            if (a == b) continue
+            key = (a < b) ? a "," b : b "," a
+            if (key in seen) continue
+            seen[key] = 1; count++
+            print a " " b; print b " " a
+        }
+    }
+    BEGIN { srand(seed); graph(p); print ""; graph(t) }'
+}
+
+# Time (ms) and GED of one run, "timeout" if it did not finish
+run_ged() {
+    local limit=$1
+    shift
+    local output
+    if output=$(timeout "$limit" "$EXE" --ged --time "$@" 2>&1); then
+        echo "$(echo "$output" | grep "Time:" | awk '{print $2}') $(echo "$output" | grep "^GED:" | awk '{print $2}')"
+    else
+        echo "timeout -"
+    fi
+}
+
+show_ms() {
+    if [ "$1" = "timeout" ]; then echo "timeout"; else echo "${1}ms"; fi
+}
+
+echo "=== Running bit-parallel benchmarks (timeout ${TIMEOUT}s) ==="
+echo "Pattern Size,Target Size,Average Degree,Bitset Time (ms),Bitset GED,ILP Time (ms),ILP GED,MCS Time (ms),MCS GED" > "$RESULTS_FILE"
+
+# Average degree, then pattern:target sizes
+benchmark_family() {
+    local degree=$1
+    shift
+    for sizes in "$@"; do
+        local p=${sizes%:*}
+        local t=${sizes#*:}
+        local input_file="$BENCHMARKS_DIR/bitset_${p}_in_${t}_d${degree}.txt"
+        generate_random_pair $p $t $degree $((p * 1000 + t)) > "$input_file"
+
+        read -r time_bit ged_bit <<< "$(run_ged "$TIMEOUT" "$input_file")"
+        read -r time_ilp ged_ilp <<< "$(run_ged "$TIMEOUT" --no-bitset "$input_file")"
+        read -r time_mcs ged_mcs <<< "$(run_ged "$TIMEOUT" --mcs "$input_file")"
+
+        echo "G($p) in G($t), degree $degree: bitset=$(show_ms $time_bit) (GED=$ged_bit), ILP=$(show_ms $time_ilp) (GED=$ged_ilp), MCS=$(show_ms $time_mcs) (GED=$ged_mcs)"
+        echo "$p,$t,$degree,$time_bit,$ged_bit,$time_ilp,$ged_ilp,$time_mcs,$ged_mcs" >> "$RESULTS_FILE"
+        rm -f "$input_file"
+    done
+}
+
+echo "--- Sparse random pairs (degree 2) ---"
+benchmark_family 2 6:8 8:10 10:12 12:14 16:20 24:30 40:48 60:64 100:120
+echo "--- Denser random pairs (degree 4) ---"
+benchmark_family 4 6:8 8:10 10:12 12:14 16:20
+echo "--- Small patterns in larger targets (degree 3, Bitset<128> above 64 vertices) ---"
+benchmark_family 3 8:40 9:64 10:64 7:100 8:120
+
+echo ""
+echo "=== Bit-parallel benchmark complete ==="
+echo "Results saved to: $RESULTS_FILE"
@@ -0,0 +1,45 @@
+#!/bin/bash
+# Model build benchmark for gempp (macOS/Linux)
+# Formulation build time and model heap (minext and GED, no solving) on random graph pairs.
+# Usage: ./scripts/benchmark_build.sh [sizes...]   (default: 100 200 300)
+#        DEGREE=<d> sets the average out-degree of the random graphs (default: 2)
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/build"
+BENCHMARKS_DIR="$PROJECT_DIR/benchmarks"
+BENCH="$BUILD_DIR/gempp_bench"
+RESULTS_FILE="$BENCHMARKS_DIR/results_build.csv"
+
+SIZES=${*:-"100 200 300"}
+DEGREE=${DEGREE:-2}
+
+echo "=== Building gempp_bench ==="
+mkdir -p "$BUILD_DIR"
+cd "$BUILD_DIR"
+cmake .. >/dev/null
+cmake --build . --parallel --target gempp_bench >/dev/null
+cd "$PROJECT_DIR"
+
+if [ ! -f "$BENCH" ]; then
+    echo "Build failed: gempp_bench not found"
+    exit 1
+fi
+
+mkdir -p "$BENCHMARKS_DIR"
+
+echo "=== Running model build benchmarks ==="
+echo "Vertices,Degree,Formulation,Pattern Edges,Target Edges,Build (ms),Model Heap (bytes)" > "$RESULTS_FILE"
+
+for n in $SIZES; do
+    "$BENCH" build "$n" "$DEGREE" | tail -n +2 | while IFS=, read -r input formulation pe te ms bytes; do
+        echo "n=$n $formulation: ${ms}ms, ${bytes}B"
+        echo "$n,$DEGREE,$formulation,$pe,$te,$ms,$bytes" >> "$RESULTS_FILE"
+    done
+done
+
+echo ""
+echo "=== Model build benchmark complete ==="
+echo "Results saved to: $RESULTS_FILE"
@@ -0,0 +1,69 @@
+#!/bin/bash
+# Input I/O benchmark for gempp (macOS/Linux)
+# Compares parse wall time of plain-text vs gzip-compressed adjacency matrices.
+# Usage: ./scripts/benchmark_io.sh [sizes...]   (default: 1000 2000 4000)
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/build"
+BENCHMARKS_DIR="$PROJECT_DIR/benchmarks"
+BENCH="$BUILD_DIR/gempp_bench"
+RESULTS_FILE="$BENCHMARKS_DIR/results_io.csv"
+
+SIZES=${*:-"1000 2000 4000"}
+
+echo "=== Building gempp_bench ==="
+mkdir -p "$BUILD_DIR"
+cd "$BUILD_DIR"
+cmake .. >/dev/null
+cmake --build . --parallel --target gempp_bench >/dev/null
+cd "$PROJECT_DIR"
+
+if [ ! -f "$BENCH" ]; then
+    echo "Build failed: gempp_bench not found"
+    exit 1
+fi
+
+mkdir -p "$BENCHMARKS_DIR"
+
+# Generate a random sparse directed graph pair (pattern = target = n vertices, ~1% density)
+generate_pair() {
+    local n=$1
+    N="$n" python3 - <<'PY'
+import os, random
+n = int(os.environ["N"])
+random.seed(n)
+out = []
+for _ in range(2):
+    out.append(str(n))
+    for i in range(n):
+        out.append(" ".join("1" if random.random() < 0.01 else "0" for _ in range(n)))
+    out.append("")
+print("\n".join(out))
+PY
+}
+
+echo "=== Running I/O benchmarks ==="
+echo "Vertices,Plain Size (bytes),Gzip Size (bytes),Plain Parse (ms),Gzip Parse (ms)" > "$RESULTS_FILE"
+
+for n in $SIZES; do
+    input_file="$BENCHMARKS_DIR/io_dense_${n}.txt"
+    generate_pair "$n" > "$input_file"
+    gzip -c "$input_file" > "$input_file.gz"
+
+    plain_size=$(wc -c < "$input_file" | tr -d ' ')
+    gz_size=$(wc -c < "$input_file.gz" | tr -d ' ')
+    plain_ms=$("$BENCH" parse "$input_file" | tail -1 | awk -F, '{print $5}')
+    gz_ms=$("$BENCH" parse "$input_file.gz" | tail -1 | awk -F, '{print $5}')
+
+    echo "n=$n: plain ${plain_size}B ${plain_ms}ms, gzip ${gz_size}B ${gz_ms}ms"
+    echo "$n,$plain_size,$gz_size,$plain_ms,$gz_ms" >> "$RESULTS_FILE"
+
+    rm -f "$input_file" "$input_file.gz"
+done
+
+echo ""
+echo "=== I/O benchmark complete ==="
+echo "Results saved to: $RESULTS_FILE"
@@ -0,0 +1,155 @@
+#!/bin/bash
+# Benchmark script for gempp - native GED search (--mcs, --astar) vs the GED ILP
+# Usage: ./scripts/benchmark_search.sh [ilp_timeout_seconds]
+# ILP runs are stopped after ilp_timeout_seconds (default 120) and reported as "timeout"
+
+set -e
+
+ILP_TIMEOUT=${1:-120}
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_DIR/build"
+BENCHMARKS_DIR="$PROJECT_DIR/benchmarks"
+EXE="$PROJECT_DIR/gempp"
+RESULTS_FILE="$BENCHMARKS_DIR/results_search.csv"
+
+echo "=== Building gempp ==="
+mkdir -p "$BUILD_DIR"
+cd "$BUILD_DIR"
+cmake .. >/dev/null
+cmake --build . --parallel >/dev/null
+cd "$PROJECT_DIR"
+
+if [ ! -f "$EXE" ]; then
+    echo "Build failed: executable not found"
+    exit 1
+fi
+
+mkdir -p "$BENCHMARKS_DIR"
+
+# Generate a complete graph (K_n) adjacency matrix
+generate_complete_graph() {
+    local n=$1
+    echo "$n"
+    for ((i=0; i<n; i++)); do
+        row=""
+        for ((j=0; j<n; j++)); do
+            if [ $i -eq $j ]; then
+                row+="0"
+            else
+                row+="1"
+            fi
+            if [ $j -lt $((n-1)) ]; then
+                row+=" "
+            fi
+        done
+        echo "$row"
+    done
+}
+
+# Generate a path graph (P_n) adjacency matrix
+generate_path_graph() {
+    local n=$1
+    echo "$n"
+    for ((i=0; i<n; i++)); do
+        row=""
+        for ((j=0; j<n; j++)); do
+            if [ $((j - i)) -eq 1 ] || [ $((i - j)) -eq 1 ]; then
+                row+="1"
+            else
+                row+="0"
+            fi
+            if [ $j -lt $((n-1)) ]; then
+                row+=" "
+            fi
+        done
+        echo "$row"
+    done
+}
+
+# Generate a cycle graph (C_n) adjacency matrix
+generate_cycle_graph() {
+    local n=$1
+    echo "$n"
+    for ((i=0; i<n; i++)); do
+        row=""
+        for ((j=0; j<n; j++)); do
+            if [ $((j - i)) -eq 1 ] || [ $((i - j)) -eq 1 ] || \
+               ([ $i -eq 0 ] && [ $j -eq $((n-1)) ]) || \
+               ([ $i -eq $((n-1)) ] && [ $j -eq 0 ]); then
+                row+="1"
+            else
+                row+="0"
+            fi
+            if [ $j -lt $((n-1)) ]; then
+                row+=" "
+            fi
+        done
+        echo "$row"
+    done
+}
+
+generate() {
+    case $1 in
+        complete) generate_complete_graph $2 ;;
+        path) generate_path_graph $2 ;;
+        cycle) generate_cycle_graph $2 ;;
+    esac
+}
+
+# Time (ms) and GED of one run, "timeout" if it did not finish
+run_ged() {
+    local limit=$1
+    shift
+    local output
+    if output=$(timeout "$limit" "$EXE" --ged --time "$@" 2>&1); then
+        echo "$(echo "$output" | grep "Time:" | awk '{print $2}') $(echo "$output" | grep "^GED:" | awk '{print $2}')"
+    else
+        echo "timeout -"
+    fi
+}
+
+show_ms() {
+    if [ "$1" = "timeout" ]; then echo "timeout"; else echo "${1}ms"; fi
+}
+
+echo "=== Running GED search benchmarks (ILP timeout ${ILP_TIMEOUT}s) ==="
+echo "Pattern Size,Target Size,Pattern Type,Target Type,ILP Time (ms),ILP GED,DFS Time (ms),DFS GED,A* Time (ms),A* GED" > "$RESULTS_FILE"
+
+# Pattern type, target type, then pattern/target sizes
+benchmark_family() {
+    local ptype=$1
+    local ttype=$2
+    shift 2
+    for sizes in "$@"; do
+        local p=${sizes%:*}
+        local t=${sizes#*:}
+        local input_file="$BENCHMARKS_DIR/search_${ptype}${p}_in_${ttype}${t}.txt"
+        generate $ptype $p > "$input_file"
+        echo "" >> "$input_file"
+        generate $ttype $t >> "$input_file"
+
+        read -r time_ilp ged_ilp <<< "$(run_ged "$ILP_TIMEOUT" --no-bitset "$input_file")"
+        read -r time_dfs ged_dfs <<< "$(run_ged 600 --mcs "$input_file")"
+        read -r time_astar ged_astar <<< "$(run_ged 600 --astar "$input_file")"
+
+        echo "$ptype $p in $ttype $t: ILP=$(show_ms $time_ilp) (GED=$ged_ilp), DFS=$(show_ms $time_dfs) (GED=$ged_dfs), A*=$(show_ms $time_astar) (GED=$ged_astar)"
+        echo "$p,$t,$ptype,$ttype,$time_ilp,$ged_ilp,$time_dfs,$ged_dfs,$time_astar,$ged_astar" >> "$RESULTS_FILE"
+    done
+}
+
+echo "--- Complete graphs ---"
+benchmark_family complete complete 5:8 8:10 10:12 12:15 15:15
+echo "--- Path graphs ---"
+benchmark_family path path 6:10 10:14 14:20
+echo "--- Cycle in complete graph ---"
+benchmark_family cycle complete 6:8 8:10 10:12
+echo "--- Complete graph in path ---"
+benchmark_family complete path 5:10 6:12 8:14
+echo "--- Cycle in path ---"
+benchmark_family cycle path 8:10 10:12 12:14
+
+echo ""
+echo "=== Search benchmark complete ==="
+echo "Results saved to: $RESULTS_FILE"
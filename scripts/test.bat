@@ -72,7 +72,11 @@ if not exist "%EXPECTED%" (
     exit /b 0
 )
 
-"%EXE%" "%INPUT%" > "%ACTUAL%" 2>&1
+REM Optional command-line flags of the case (one line, e.g. "--mcs")
+set ARGS=
+if exist "%TEST_DIR%\args.txt" set /p ARGS=<"%TEST_DIR%\args.txt"
+
+"%EXE%" %ARGS% "%INPUT%" > "%ACTUAL%" 2>&1
 
 REM Compare only first 5 lines (GED, Is Subgraph, Minimal Extension, Vertices count, Edges count)
 REM The specific vertices/edges can vary between equivalent optimal solutions
@@ -43,8 +43,14 @@ for test_dir in "$TESTS_DIR"/*/; do
         continue
     fi
 
+    # Optional command-line flags of the case (one line, e.g. "--mcs")
+    args=""
+    if [ -f "$test_dir/args.txt" ]; then
+        args=$(cat "$test_dir/args.txt")
+    fi
+
     # Run the test
-    actual=$("$EXE" "$input_file" 2>&1) || true
+    actual=$("$EXE" $args "$input_file" 2>&1) || true
     expected=$(cat "$expected_file")
 
     # Compare only first 5 lines (GED, Is Subgraph, Minimal Extension, Vertices count, Edges count)
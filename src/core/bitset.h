@@ -0,0 +1,136 @@
+#ifndef V2_BITSET_H
+#define V2_BITSET_H
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace gempp {
+
+// Fixed-size set of Bits indices held in machine words, for the bit-parallel solvers: set
+// operations are one instruction per word and sizes a POPCNT each, with no heap storage.
+// Bits is a multiple of 64 (Bitset<64>, Bitset<128>).
+template <int Bits>
+class Bitset {
+public:
+    static_assert(Bits > 0 && Bits % 64 == 0, "Bitset size must be a multiple of 64");
+    static constexpr int WORDS = Bits / 64;
+
+    Bitset() : words_() {}
+
+    // Indices 0..n-1
+    static Bitset firstBits(int n) {
+        Bitset s;
+        for (int w = 0; w < WORDS; ++w) {
+            int left = n - 64 * w;
+            s.words_[w] = left >= 64 ? ~uint64_t(0) : (left > 0 ? (uint64_t(1) << left) - 1 : 0);
+        }
+        return s;
+    }
+
+    void set(int i) { words_[i / 64] |= uint64_t(1) << (i % 64); }
+    void reset(int i) { words_[i / 64] &= ~(uint64_t(1) << (i % 64)); }
+    bool test(int i) const { return (words_[i / 64] >> (i % 64)) & 1; }
+
+    Bitset operator&(const Bitset& o) const {
+        Bitset r;
+        for (int w = 0; w < WORDS; ++w) r.words_[w] = words_[w] & o.words_[w];
+        return r;
+    }
+
+    Bitset operator|(const Bitset& o) const {
+        Bitset r;
+        for (int w = 0; w < WORDS; ++w) r.words_[w] = words_[w] | o.words_[w];
+        return r;
+    }
+
+    // Elements of this set not in o
+    Bitset operator-(const Bitset& o) const {
+        Bitset r;
+        for (int w = 0; w < WORDS; ++w) r.words_[w] = words_[w] & ~o.words_[w];
+        return r;
+    }
+
+    bool operator==(const Bitset& o) const {
+        for (int w = 0; w < WORDS; ++w) {
+            if (words_[w] != o.words_[w]) return false;
+        }
+        return true;
+    }
+
+    bool any() const {
+        for (int w = 0; w < WORDS; ++w) {
+            if (words_[w]) return true;
+        }
+        return false;
+    }
+
+    int count() const {
+        int c = 0;
+        for (int w = 0; w < WORDS; ++w) c += popcount(words_[w]);
+        return c;
+    }
+
+    // True if the intersection with o is not empty, without building it
+    bool intersects(const Bitset& o) const {
+        for (int w = 0; w < WORDS; ++w) {
+            if (words_[w] & o.words_[w]) return true;
+        }
+        return false;
+    }
+
+    // Size of the intersection with o, without building it
+    int countAnd(const Bitset& o) const {
+        int c = 0;
+        for (int w = 0; w < WORDS; ++w) c += popcount(words_[w] & o.words_[w]);
+        return c;
+    }
+
+    // Calls f(i) for every element i, ascending
+    template <class F>
+    void forEach(F f) const {
+        for (int w = 0; w < WORDS; ++w) {
+            for (uint64_t bits = words_[w]; bits; bits &= bits - 1) f(64 * w + trailingZeros(bits));
+        }
+    }
+
+private:
+    // __popcnt64 needs the POPCNT instruction (opt-in, see GEMPP_POPCNT) and an x64 target;
+    // elsewhere MSVC counts in software
+    static int popcount(uint64_t x) {
+#if !defined(_MSC_VER)
+        return __builtin_popcountll(x);
+#elif defined(GEMPP_POPCNT) && defined(_M_X64)
+        return static_cast<int>(__popcnt64(x));
+#else
+        x = x - ((x >> 1) & 0x5555555555555555ULL);
+        x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+#endif
+    }
+
+    // x != 0
+    static int trailingZeros(uint64_t x) {
+#if !defined(_MSC_VER)
+        return __builtin_ctzll(x);
+#elif defined(_M_X64) || defined(_M_ARM64)
+        unsigned long idx;
+        _BitScanForward64(&idx, x);
+        return static_cast<int>(idx);
+#else
+        unsigned long idx;
+        if (_BitScanForward(&idx, static_cast<unsigned long>(x))) return static_cast<int>(idx);
+        _BitScanForward(&idx, static_cast<unsigned long>(x >> 32));
+        return static_cast<int>(idx) + 32;
+#endif
+    }
+
+    uint64_t words_[WORDS];
+};
+
+} // namespace gempp
+
+#endif // V2_BITSET_H
@@ -0,0 +1,113 @@
+#ifndef V2_GZIP_DECODER_H
+#define V2_GZIP_DECODER_H
+
+#include "types.h"
+#include <zlib/zlib.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gempp {
+
+// In-memory gzip decompression through the zlib bundled with GLPK.
+// The compressed bytes are inflated straight from the caller's buffer (typically a
+// MappedFile); no temporary file is written.
+class GzipDecoder {
+public:
+    static bool isGzip(const char* data, size_t size) {
+        return size >= 2 &&
+               static_cast<unsigned char>(data[0]) == 0x1f &&
+               static_cast<unsigned char>(data[1]) == 0x8b;
+    }
+
+    // Decompresses all gzip members in [data, data + size) into `out`.
+    //
+    // The whole text is inflated before parsing rather than streamed: the matrix parser scans
+    // one contiguous buffer in place and splits large matrices into row ranges parsed on
+    // separate threads. Peak memory is therefore the text plus the compressed file, and the
+    // buffer is kept close to the text size: it starts at the ISIZE trailer when that is
+    // plausible, then grows by a quarter at a time (not doubling), and never past what
+    // deflate can produce from `size` bytes.
+    static void decompress(const char* data, size_t size, std::vector<char>& out,
+                           const std::string& name)
+    {
+        // Deflate expands at most MAX_RATIO:1 (per member, so for the whole file too)
+        size_t limit = size > SIZE_MAX / MAX_RATIO ? SIZE_MAX : size * MAX_RATIO + 1;
+
+        // ISIZE trailer (uncompressed size mod 2^32) of the last member as a size hint,
+        // ignored when no deflate stream of this size could produce it
+        size_t hint = size * 4;
+        if (size >= 18) {
+            const unsigned char* t = reinterpret_cast<const unsigned char*>(data + size - 4);
+            uint32_t isize = uint32_t(t[0]) | (uint32_t(t[1]) << 8) |
+                             (uint32_t(t[2]) << 16) | (uint32_t(t[3]) << 24);
+            if (isize < limit) hint = isize;
+        }
+        out.clear();
+        out.resize(std::min(hint, limit - 1) + 1);
+
+        z_stream zs = {};
+        // 15 window bits + 16: expect a gzip header
+        if (inflateInit2(&zs, 15 + 16) != Z_OK) {
+            throw Exception("Cannot initialize gzip decoder for: " + name);
+        }
+
+        const unsigned char* in = reinterpret_cast<const unsigned char*>(data);
+        size_t inLeft = size;
+        size_t produced = 0;
+        int ret = Z_OK;
+
+        while (true) {
+            // zlib counts are 32-bit; feed large inputs piecewise
+            if (zs.avail_in == 0 && inLeft > 0) {
+                uInt chunk = static_cast<uInt>(inLeft > CHUNK ? CHUNK : inLeft);
+                zs.next_in = const_cast<unsigned char*>(in);
+                zs.avail_in = chunk;
+                in += chunk;
+                inLeft -= chunk;
+            }
+            if (produced == out.size()) {
+                // reserve() first so the vector does not pick its own (doubling) capacity
+                size_t room = limit > out.size() ? limit - out.size() : 0;
+                size_t grown = out.size() + std::min(std::max(out.size() / 4, CHUNK), std::max(room, CHUNK));
+                out.reserve(grown);
+                out.resize(grown);
+            }
+            size_t room = out.size() - produced;
+            zs.next_out = reinterpret_cast<unsigned char*>(out.data() + produced);
+            zs.avail_out = static_cast<uInt>(room > CHUNK ? CHUNK : room);
+            uInt before = zs.avail_out;
+
+            ret = inflate(&zs, Z_NO_FLUSH);
+            produced += before - zs.avail_out;
+
+            if (ret == Z_STREAM_END) {
+                // Concatenated members (e.g. `cat a.gz b.gz`)
+                if (zs.avail_in == 0 && inLeft == 0) break;
+                if (inflateReset(&zs) != Z_OK) break;
+                continue;
+            }
+            if (ret == Z_BUF_ERROR && zs.avail_in == 0 && inLeft == 0) {
+                inflateEnd(&zs);
+                throw Exception("Truncated gzip data in file: " + name);
+            }
+            if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                inflateEnd(&zs);
+                throw Exception("Corrupt gzip data in file: " + name);
+            }
+        }
+
+        inflateEnd(&zs);
+        out.resize(produced);
+    }
+
+private:
+    static constexpr size_t CHUNK = 1 << 20;
+    static constexpr size_t MAX_RATIO = 1032;
+};
+
+} // namespace gempp
+
+#endif // V2_GZIP_DECODER_H
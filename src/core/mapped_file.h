@@ -0,0 +1,105 @@
+#ifndef V2_MAPPED_FILE_H
+#define V2_MAPPED_FILE_H
+
+#include "types.h"
+#include <cstddef>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gempp {
+
+// Read-only memory mapping of a whole file.
+// The mapping lives as long as the object; data() is NOT null-terminated.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename) : data_(nullptr), size_(0) {
+#ifdef _WIN32
+        file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) {
+            throw Exception("Cannot open file: " + filename);
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_, &size)) {
+            CloseHandle(file_);
+            throw Exception("Cannot open file: " + filename);
+        }
+        size_ = static_cast<size_t>(size.QuadPart);
+        mapping_ = nullptr;
+        if (size_ > 0) {
+            mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping_) {
+                data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+            }
+            if (!data_) {
+                if (mapping_) CloseHandle(mapping_);
+                CloseHandle(file_);
+                throw Exception("Cannot map file: " + filename);
+            }
+        }
+#else
+        fd_ = ::open(filename.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            throw Exception("Cannot open file: " + filename);
+        }
+        struct stat st;
+        if (::fstat(fd_, &st) != 0 || !S_ISREG(st.st_mode)) {
+            ::close(fd_);
+            throw Exception("Cannot open file: " + filename);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd_);
+                throw Exception("Cannot map file: " + filename);
+            }
+            ::madvise(p, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(p);
+        }
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        CloseHandle(file_);
+#else
+        if (data_) ::munmap(const_cast<char*>(data_), size_);
+        ::close(fd_);
+#endif
+    }
+
+    // Disable copy
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_;
+    size_t size_;
+#ifdef _WIN32
+    HANDLE file_;
+    HANDLE mapping_;
+#else
+    int fd_;
+#endif
+};
+
+} // namespace gempp
+
+#endif // V2_MAPPED_FILE_H
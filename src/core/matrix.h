@@ -1,50 +1,132 @@
 #ifndef V2_MATRIX_H
 #define V2_MATRIX_H
 
+#include "types.h"
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <string>
 #include <vector>
 
 namespace gempp {
 
+// std::allocator replacement returning storage aligned to `Align` bytes (a cache line by
+// default), so every Matrix buffer starts on a fresh line
+template <class T, size_t Align = 64>
+class AlignedAllocator {
+public:
+    using value_type = T;
+
+    template <class U>
+    struct rebind { using other = AlignedAllocator<U, Align>; };
+
+    AlignedAllocator() noexcept {}
+    template <class U>
+    AlignedAllocator(const AlignedAllocator<U, Align>&) noexcept {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+
+    void deallocate(T* p, size_t) noexcept {
+        ::operator delete(p, std::align_val_t(Align));
+    }
+
+    template <class U>
+    bool operator==(const AlignedAllocator<U, Align>&) const noexcept { return true; }
+    template <class U>
+    bool operator!=(const AlignedAllocator<U, Align>&) const noexcept { return false; }
+};
+
+// View over the elements of one matrix row
+template <class T>
+class RowView {
+public:
+    RowView(T* begin, int size) : begin_(begin), size_(size) {}
+
+    T* begin() const { return begin_; }
+    T* end() const { return begin_ + size_; }
+    int size() const { return size_; }
+    T& operator[](int j) const { return begin_[j]; }
+
+private:
+    T* begin_;
+    int size_;
+};
+
+// Dense rows x cols matrix in a single row-major buffer.
+//
+// Element (i, j) lives at data()[i * cols + j]. getElement, setElement, operator() and
+// row() do not check their indices in release builds (they assert in debug builds, i.e.
+// without NDEBUG); at() always checks and throws on out-of-range indices.
 template <class T>
 class Matrix {
 public:
     Matrix() : rows_(0), cols_(0) {}
 
-    Matrix(int rows, int cols, T init = T()) : rows_(rows), cols_(cols) {
-        matrix_.resize(rows);
-        for (int i = 0; i < rows; ++i) {
-            matrix_[i].resize(cols, init);
-        }
-    }
+    Matrix(int rows, int cols, T init = T())
+        : rows_(rows), cols_(cols),
+          data_(static_cast<size_t>(rows) * static_cast<size_t>(cols), init)
+    {}
 
     int getRowsNumber() const { return rows_; }
     int getColumnsNumber() const { return cols_; }
 
-    T getElement(int i, int j) const {
-        if (i >= 0 && i < rows_ && j >= 0 && j < cols_) {
-            return matrix_[i][j];
-        }
-        return T();
+    T getElement(int i, int j) const { return data_[offset(i, j)]; }
+    void setElement(int i, int j, T value) { data_[offset(i, j)] = value; }
+
+    T& operator()(int i, int j) { return data_[offset(i, j)]; }
+    const T& operator()(int i, int j) const { return data_[offset(i, j)]; }
+
+    // Bounds-checked access
+    T& at(int i, int j) {
+        check(i, j);
+        return data_[index(i, j)];
     }
 
-    void setElement(int i, int j, T value) {
-        if (i >= 0 && i < rows_ && j >= 0 && j < cols_) {
-            matrix_[i][j] = value;
-        }
+    const T& at(int i, int j) const {
+        check(i, j);
+        return data_[index(i, j)];
     }
 
-    std::vector<T>& operator[](int i) {
-        return matrix_[i];
+    RowView<T> row(int i) {
+        assert(i >= 0 && i < rows_);
+        return RowView<T>(data_.data() + index(i, 0), cols_);
     }
 
-    const std::vector<T>& operator[](int i) const {
-        return matrix_[i];
+    RowView<const T> row(int i) const {
+        assert(i >= 0 && i < rows_);
+        return RowView<const T>(data_.data() + index(i, 0), cols_);
     }
 
+    // Pointer to the first element of row i, so that m[i][j] still works
+    T* operator[](int i) { return row(i).begin(); }
+    const T* operator[](int i) const { return row(i).begin(); }
+
+    T* data() { return data_.data(); }
+    const T* data() const { return data_.data(); }
+
 private:
+    size_t index(int i, int j) const {
+        return static_cast<size_t>(i) * static_cast<size_t>(cols_) + static_cast<size_t>(j);
+    }
+
+    size_t offset(int i, int j) const {
+        assert(i >= 0 && i < rows_ && j >= 0 && j < cols_);
+        return index(i, j);
+    }
+
+    void check(int i, int j) const {
+        if (i < 0 || i >= rows_ || j < 0 || j >= cols_) {
+            throw Exception("Matrix index (" + std::to_string(i) + "," + std::to_string(j) +
+                            ") is out of range for a " + std::to_string(rows_) + "x" +
+                            std::to_string(cols_) + " matrix");
+        }
+    }
+
     int rows_;
     int cols_;
-    std::vector<std::vector<T>> matrix_;
+    std::vector<T, AlignedAllocator<T>> data_;
 };
 
 } // namespace gempp
@@ -0,0 +1,42 @@
+#ifndef V2_RESOURCE_USAGE_H
+#define V2_RESOURCE_USAGE_H
+
+#include <cstddef>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef PSAPI_VERSION
+#define PSAPI_VERSION 2  // K32GetProcessMemoryInfo from kernel32, no psapi.lib
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace gempp {
+
+// Peak resident set size of the current process in bytes (0 if unavailable)
+inline size_t peakResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<size_t>(counters.PeakWorkingSetSize);
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);         // bytes
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;  // kilobytes
+#endif
+#endif
+}
+
+} // namespace gempp
+
+#endif // V2_RESOURCE_USAGE_H
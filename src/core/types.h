@@ -62,6 +62,13 @@ public:
         }
     }
 
+    static std::string toLower(const std::string& str) {
+        std::string result = str;
+        std::transform(result.begin(), result.end(), result.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return result;
+    }
+
     static std::string fromInt(int value) {
         return std::to_string(value);
     }
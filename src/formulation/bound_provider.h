@@ -0,0 +1,167 @@
+#ifndef V2_BOUND_PROVIDER_H
+#define V2_BOUND_PROVIDER_H
+
+#include "../model/graph.h"
+#include "../model/problem.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gempp {
+
+// Per-unit costs of unmatched elements, shared by the matching formulations: deleting a
+// pattern vertex / arc and inserting a target vertex / arc. Minimal extension only charges
+// the pattern side (insertion costs 0). Edge costs are per arc, so an undirected edge copy
+// counts twice and a self-loop once (see MinimumCostSubgraphMatching).
+struct EditCosts {
+    double vertexDeletion;
+    double vertexInsertion;
+    double edgeDeletion;
+    double edgeInsertion;
+};
+
+// Source of a proven lower bound on the optimal objective of a problem, computed without
+// solving it. Formulations register theirs in a LowerBounds set (addBoundProviders), and
+// the solver stops branch and bound as soon as the incumbent reaches the best bound.
+class BoundProvider {
+public:
+    virtual ~BoundProvider() {}
+
+    virtual std::string getName() const = 0;
+
+    // Lower bound on the optimum (-inf if none applies)
+    virtual double getLowerBound() const = 0;
+};
+
+// Base of the combinatorial bounds of the matching formulations: the objective is the cost
+// of unmatched elements plus substitution costs, so counting elements that cannot be matched
+// bounds it as long as no substitution cost is negative.
+class MatchingBound : public BoundProvider {
+public:
+    MatchingBound(const Problem* pb, const EditCosts& costs) : pb_(pb), costs_(costs) {}
+
+    double getLowerBound() const override {
+        if (!nonNegativeSubstitutions(true) || !nonNegativeSubstitutions(false)) return -INFINITY;
+
+        const Graph* q = pb_->getQuery();
+        const Graph* t = pb_->getTarget();
+        int nVP = q->getVertexCount();
+        int nVT = t->getVertexCount();
+        long arcsP = q->getTotalArcMultiplicity();
+        long arcsT = t->getTotalArcMultiplicity();
+        long matched = std::min(std::min(arcsP, arcsT), getMatchableArcs());
+
+        return costs_.vertexDeletion * std::max(0, nVP - nVT) +
+               costs_.vertexInsertion * std::max(0, nVT - nVP) +
+               costs_.edgeDeletion * (arcsP - matched) + costs_.edgeInsertion * (arcsT - matched);
+    }
+
+protected:
+    // Upper bound on the number of pattern arcs that can be matched onto target arcs
+    virtual long getMatchableArcs() const = 0;
+
+    const Problem* pb_;
+
+private:
+    bool nonNegativeSubstitutions(bool isVertex) const {
+        const CostTable& table = pb_->getCostTable(isVertex);
+        if (table.isUniform()) return table.getUniform() >= 0.0;
+        int rows = isVertex ? pb_->getQuery()->getVertexCount() : pb_->getQuery()->getEdgeCount();
+        int cols = isVertex ? pb_->getTarget()->getVertexCount() : pb_->getTarget()->getEdgeCount();
+        for (int a = 0; a < rows; ++a) {
+            for (int b = 0; b < cols; ++b) {
+                if (table.get(a, b) < 0.0) return false;
+            }
+        }
+        return true;
+    }
+
+    EditCosts costs_;
+};
+
+// Element counts: at most min(nVP, nVT) vertices and min(arcs) arcs are matched
+class CardinalityBound : public MatchingBound {
+public:
+    using MatchingBound::MatchingBound;
+
+    std::string getName() const override { return "cardinality"; }
+
+protected:
+    long getMatchableArcs() const override {
+        return std::min(pb_->getQuery()->getTotalArcMultiplicity(),
+                        pb_->getTarget()->getTotalArcMultiplicity());
+    }
+};
+
+// Degree sequences: the arcs leaving (entering) pattern vertex i can only be matched onto
+// arcs leaving (entering) the vertex it is mapped to, so at most sum(min(deg(i), deg(k)))
+// over the mapped pairs are matched. Pairing both degree sequences in descending order
+// maximizes that sum over all injective mappings.
+class DegreeSequenceBound : public MatchingBound {
+public:
+    using MatchingBound::MatchingBound;
+
+    std::string getName() const override { return "degree sequence"; }
+
+protected:
+    long getMatchableArcs() const override {
+        const Graph* q = pb_->getQuery();
+        const Graph* t = pb_->getTarget();
+        long out = pairedDegrees(arcDegrees(q, true), arcDegrees(t, true));
+        if (!q->isDirected()) return out;  // out- and in-arcs coincide
+        return std::min(out, pairedDegrees(arcDegrees(q, false), arcDegrees(t, false)));
+    }
+
+private:
+    // Arcs (with multiplicity) leaving / entering each vertex; an undirected edge is two arcs
+    // and a self-loop one
+    static std::vector<long> arcDegrees(const Graph* g, bool out) {
+        std::vector<long> degree(g->getVertexCount(), 0);
+        for (int e = 0; e < g->getEdgeCount(); ++e) {
+            int origin = g->getOrigin(e);
+            int target = g->getTarget(e);
+            int m = g->getMultiplicity(e);
+            if (!g->isDirected()) {
+                degree[origin] += m;
+                if (target != origin) degree[target] += m;
+            } else {
+                degree[out ? origin : target] += m;
+            }
+        }
+        return degree;
+    }
+
+    static long pairedDegrees(std::vector<long> p, std::vector<long> t) {
+        std::sort(p.begin(), p.end(), std::greater<long>());
+        std::sort(t.begin(), t.end(), std::greater<long>());
+        long sum = 0;
+        for (size_t r = 0; r < std::min(p.size(), t.size()); ++r) sum += std::min(p[r], t[r]);
+        return sum;
+    }
+};
+
+// Lower bounds registered for a problem; the best (largest) one is used
+class LowerBounds {
+public:
+    void add(std::unique_ptr<BoundProvider> provider) { providers_.push_back(std::move(provider)); }
+
+    const std::vector<std::unique_ptr<BoundProvider>>& getProviders() const { return providers_; }
+
+    // Best lower bound over all providers (-inf if there are none)
+    double get() const {
+        double best = -INFINITY;
+        for (const auto& provider : providers_) best = std::max(best, provider->getLowerBound());
+        return best;
+    }
+
+private:
+    std::vector<std::unique_ptr<BoundProvider>> providers_;
+};
+
+} // namespace gempp
+
+#endif // V2_BOUND_PROVIDER_H
@@ -0,0 +1,120 @@
+#ifndef V2_EDGE_CONSISTENCY_H
+#define V2_EDGE_CONSISTENCY_H
+
+#include "../integer_programming/linear_program.h"
+#include "../model/graph.h"
+#include "../model/problem.h"
+#include "matching_layout.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace gempp {
+
+// Separation of the F2 edge consistency rows of MinimumCostSubgraphMatching and
+// LinearGraphEditDistance, for models built without them (setLazyEdgeConstraints).
+//
+// The rows are the ones the formulations build, per pattern edge ij (copies c) and target
+// vertex k:
+// - directed: sum of y_ij,kl over edges kl leaving k <= c * x_ik, and over edges entering k
+//   <= c * x_jk;
+// - undirected: sum of y_ij,kl over edges kl incident to k <= c * (x_ik + x_jk), x_jk only
+//   if j != i.
+// A scan sums the y values of each pattern edge per target vertex, in O(nEP * (nET + nVT)).
+class EdgeConsistency {
+public:
+    explicit EdgeConsistency(const Problem* pb)
+        : pb_(pb), layout_(pb), undirected_(!pb->getQuery()->isDirected()),
+          out_(pb->getTarget()->getVertexCount()), in_(pb->getTarget()->getVertexCount())
+    {}
+
+    // Appends to rows (closed without compaction against variables) the F2 rows that values,
+    // one per column, violate by more than tolerance. NaN values (columns left out of the
+    // model) read as 0. Returns the number of rows appended.
+    int separate(const std::vector<double>& values, ConstraintStore& rows,
+                 double tolerance = 1e-6) {
+        const Graph* q = pb_->getQuery();
+        const Graph* t = pb_->getTarget();
+        int nVT = t->getVertexCount();
+        int nET = t->getEdgeCount();
+        int added = 0;
+        for (int ij = 0; ij < q->getEdgeCount(); ++ij) {
+            int i = q->getOrigin(ij);
+            int j = q->getTarget(ij);
+            double copies = q->getMultiplicity(ij);
+
+            // y mass of ij leaving and entering each target vertex (undirected: out_ holds
+            // the mass incident to it)
+            std::fill(out_.begin(), out_.end(), 0.0);
+            std::fill(in_.begin(), in_.end(), 0.0);
+            for (int kl = 0; kl < nET; ++kl) {
+                double y = value(values, layout_.y(ij, kl));
+                if (y == 0.0) continue;
+                int k = t->getOrigin(kl);
+                int l = t->getTarget(kl);
+                out_[k] += y;
+                if (undirected_) {
+                    if (l != k) out_[l] += y;
+                } else {
+                    in_[l] += y;
+                }
+            }
+
+            for (int k = 0; k < nVT; ++k) {
+                if (undirected_) {
+                    double x = value(values, layout_.x(i, k));
+                    if (j != i) x += value(values, layout_.x(j, k));
+                    if (out_[k] - copies * x > tolerance) {
+                        addUndirectedRow(rows, ij, i, j, k, copies);
+                        ++added;
+                    }
+                    continue;
+                }
+                if (out_[k] - copies * value(values, layout_.x(i, k)) > tolerance) {
+                    addDirectedRow(rows, i, k, copies, ij, t->getOutEdges(k));
+                    ++added;
+                }
+                if (in_[k] - copies * value(values, layout_.x(j, k)) > tolerance) {
+                    addDirectedRow(rows, j, k, copies, ij, t->getInEdges(k));
+                    ++added;
+                }
+            }
+        }
+        return added;
+    }
+
+private:
+    static double value(const std::vector<double>& values, int col) {
+        return std::isnan(values[col]) ? 0.0 : values[col];
+    }
+
+    // Directed row: sum of y_ij,kl over edges <= copies * x_vk
+    template <class Edges>
+    void addDirectedRow(ConstraintStore& rows, int v, int k, double copies, int ij,
+                        const Edges& edges) const {
+        rows.addTerm(layout_.x(v, k), -copies);
+        for (int kl : edges) rows.addTerm(layout_.y(ij, kl), 1.0);
+        rows.addRow(ConstraintStore::LESS_EQ, 0.0);
+    }
+
+    void addUndirectedRow(ConstraintStore& rows, int ij, int i, int j, int k, double copies) const {
+        const Graph* t = pb_->getTarget();
+        rows.addTerm(layout_.x(i, k), -copies);
+        if (j != i) rows.addTerm(layout_.x(j, k), -copies);
+        for (int kl : t->getInEdges(k)) {
+            if (t->getOrigin(kl) != k) rows.addTerm(layout_.y(ij, kl), 1.0);
+        }
+        for (int kl : t->getOutEdges(k)) rows.addTerm(layout_.y(ij, kl), 1.0);
+        rows.addRow(ConstraintStore::LESS_EQ, 0.0);
+    }
+
+    const Problem* pb_;
+    MatchingLayout layout_;
+    bool undirected_;
+    std::vector<double> out_;
+    std::vector<double> in_;
+};
+
+} // namespace gempp
+
+#endif // V2_EDGE_CONSISTENCY_H
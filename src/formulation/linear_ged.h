@@ -4,7 +4,8 @@
 #include "../model/problem.h"
 #include "../model/graph.h"
 #include "../integer_programming/linear_program.h"
-#include "../core/matrix.h"
+#include "bound_provider.h"
+#include "matching_layout.h"
 #include <cmath>
 #include <string>
 #include <vector>
@@ -15,10 +16,13 @@ namespace gempp {
 // Linear programming formulation for Graph Edit Distance (GED).
 // Uses unit insertion/deletion costs and optional substitution costs
 // provided through the Problem's cost matrices.
+// Edges of multiplicity m > 1 count as m parallel edges, as in MinimumCostSubgraphMatching.
+// Undirected graphs are modelled natively with edge insertion/deletion costs counted per arc
+// (see MinimumCostSubgraphMatching).
 class LinearGraphEditDistance {
 public:
     explicit LinearGraphEditDistance(Problem* pb)
-        : pb_(pb), lp_(nullptr), relaxed_(false)
+        : pb_(pb), lp_(nullptr), relaxed_(false), undirected_(false), lazy_edges_(false)
     {
         precision_ = 1e-9;
 
@@ -47,9 +51,10 @@ public:
         edge_deletion_cost_ = edge_deletion;
     }
 
-    // Build the linear program.
-    void init(double up = 1.0, bool relaxed = false) {
+    // Build the linear program. With a sink, constraints go to it instead of the program.
+    void init(double up = 1.0, bool relaxed = false, RowSink* sink = nullptr) {
         lp_ = new LinearProgram(LinearProgram::MINIMIZE);
+        lp_->setRowSink(sink);
         relaxed_ = relaxed;
 
         nVP = pb_->getQuery()->getVertexCount();
@@ -57,6 +62,11 @@ public:
         nEP = pb_->getQuery()->getEdgeCount();
         nET = pb_->getTarget()->getEdgeCount();
 
+        if (pb_->getQuery()->isDirected() != pb_->getTarget()->isDirected()) {
+            throw Exception("Pattern and target graphs must be both directed or both undirected");
+        }
+        undirected_ = !pb_->getQuery()->isDirected();
+
         initVariables();
         initCosts();
         restrictProblem(up);
@@ -65,8 +75,19 @@ public:
     }
 
     LinearProgram* getLinearProgram() { return lp_; }
-    const Matrix<Variable*>& getXVariables() const { return x_variables; }
-    const Matrix<Variable*>& getYVariables() const { return y_variables; }
+    const MatchingLayout& getLayout() const { return layout_; }
+
+    // Build the model without the F2 edge consistency rows, which EdgeConsistency then
+    // separates on demand (must be called before init)
+    void setLazyEdgeConstraints(bool lazy) { lazy_edges_ = lazy; }
+
+    // Combinatorial lower bounds on the edit distance (no init() needed)
+    void addBoundProviders(LowerBounds& bounds) const {
+        EditCosts costs = {vertex_deletion_cost_, vertex_insertion_cost_, edge_deletion_cost_,
+                           edge_insertion_cost_};
+        bounds.add(std::unique_ptr<BoundProvider>(new CardinalityBound(pb_, costs)));
+        bounds.add(std::unique_ptr<BoundProvider>(new DegreeSequenceBound(pb_, costs)));
+    }
 
 private:
     // Candidate-pruning / variable activation strategy (parameter `up`)
@@ -76,13 +97,13 @@ private:
     // `up` in (0,1]. The idea follows the original GEM++ strategy:
     //
     // 1) Start by ACTIVATING all x_{i,k} and y_{ij,kl} variables.
-    //    - `Variable::activate()` restores bounds to [0,1] (for binary/continuous variables).
-    //    - `Variable::deactivate()` fixes the variable to 0 by setting bounds to [0,0].
+    //    - `VariableStore::activate()` restores bounds to [0,1] (for binary/continuous variables).
+    //    - `VariableStore::deactivate()` fixes the variable to 0 by setting bounds to [0,0].
     //
     // 2) If `up < 1.0`, prune vertex-substitution candidates x_{i,k} by keeping only the
     //    cheapest fraction of candidates:
     //    - For each pattern vertex i (row-wise), compute the threshold at rank floor(|V2|*up)
-    //      among costs x_costs(i, k). Deactivate all x_{i,k} with cost > threshold.
+    //      among costs vertexCost(i, k). Deactivate all x_{i,k} with cost > threshold.
     //    - For each target vertex k (column-wise), do the analogous filtering across i.
     //
     // 3) After pruning x, prune edge-substitution variables y_{ij,kl} to keep only those that
@@ -95,63 +116,90 @@ private:
     // - Smaller `up` typically speeds up solving substantially by reducing the search space.
     // - However, this is a HEURISTIC restriction of the model: for the integer formulation,
     //   `up < 1.0` may prune away the globally optimal solution. For exact results, use `up = 1.0`.
+    // Number of parallel copies pattern edge ij and target edge kl can share
+    int edgeCapacity(int ij, int kl) const {
+        return std::min(pb_->getQuery()->getMultiplicity(ij), pb_->getTarget()->getMultiplicity(kl));
+    }
+
+    // Undirected self-loops can only be matched onto self-loops
+    bool loopsCompatible(int ij, int kl) const {
+        if (!undirected_) return true;
+        const Graph* q = pb_->getQuery();
+        const Graph* t = pb_->getTarget();
+        return (q->getOrigin(ij) == q->getTarget(ij)) == (t->getOrigin(kl) == t->getTarget(kl));
+    }
+
+    // Column indices of x_{i,k} and y_{ij,kl}
+    int xVar(int i, int k) const { return layout_.x(i, k); }
+    int yVar(int ij, int kl) const { return layout_.y(ij, kl); }
+
     void initVariables() {
-        auto varType = relaxed_ ? Variable::CONTINUOUS : Variable::BINARY;
+        auto varType = relaxed_ ? VariableStore::CONTINUOUS : VariableStore::BINARY;
+
+        // Columns follow MatchingLayout: vertex substitutions x_{i,k}, then edge
+        // substitutions y_{ij,kl}
+        layout_ = MatchingLayout(pb_);
+        VariableStore& vars = lp_->getVariables();
+        vars.reserve(layout_.size());
+        vars.setNamer([layout = layout_](int col) { return layout.name(col); });
 
-        // Vertex substitution variables
-        x_variables = Matrix<Variable*>(nVP, nVT);
         for (int i = 0; i < nVP; ++i) {
             for (int k = 0; k < nVT; ++k) {
-                std::string id = "x_" + std::to_string(i) + "," + std::to_string(k);
-                auto* v = new Variable(id, varType, 0, 1);
-                x_variables.setElement(i, k, v);
-                lp_->addVariable(v);
+                lp_->addVariable(varType, 0, 1);
             }
         }
 
-        // Edge substitution variables
-        y_variables = Matrix<Variable*>(nEP, nET);
         for (int ij = 0; ij < nEP; ++ij) {
             for (int kl = 0; kl < nET; ++kl) {
-                std::string id = "y_" + std::to_string(ij) + "," + std::to_string(kl);
-                auto* v = new Variable(id, varType, 0, 1);
-                y_variables.setElement(ij, kl, v);
-                lp_->addVariable(v);
+                int cap = edgeCapacity(ij, kl);
+                lp_->addVariable((cap > 1 && !relaxed_) ? VariableStore::BOUNDED : varType, 0, cap);
             }
         }
     }
 
     void initCosts() {
-        // Substitution cost matrices. The GED objective is:
+        // The GED objective is:
         // constant (delete+insert everything) + sum((substitution - delete - insert) * match)
-        x_costs = Matrix<double>(nVP, nVT);
-        for (int i = 0; i < nVP; ++i) {
-            for (int k = 0; k < nVT; ++k) {
-                double substitution = pb_->getCost(true, i, k);
-                x_costs.setElement(i, k, substitution - vertex_deletion_cost_ - vertex_insertion_cost_);
-            }
-        }
-
-        y_costs = Matrix<double>(nEP, nET);
+        // Substitution costs stay in the Problem's cost tables; only the per-edge
+        // insertion/deletion terms are precomputed (they apply per arc of each matched copy).
+        const Graph* q = pb_->getQuery();
+        const Graph* t = pb_->getTarget();
+        edge_deletion_costs_.resize(nEP);
         for (int ij = 0; ij < nEP; ++ij) {
-            for (int kl = 0; kl < nET; ++kl) {
-                double substitution = pb_->getCost(false, ij, kl);
-                y_costs.setElement(ij, kl, substitution - edge_deletion_cost_ - edge_insertion_cost_);
-            }
+            edge_deletion_costs_[ij] = edge_deletion_cost_ * q->getArcMultiplicity(ij) / q->getMultiplicity(ij);
         }
+        edge_insertion_costs_.resize(nET);
+        for (int kl = 0; kl < nET; ++kl) {
+            edge_insertion_costs_[kl] = edge_insertion_cost_ * t->getArcMultiplicity(kl) / t->getMultiplicity(kl);
+        }
+    }
+
+    // Objective coefficient of x_{i,k}
+    double vertexCost(int i, int k) const {
+        return pb_->getCost(true, i, k) - vertex_deletion_cost_ - vertex_insertion_cost_;
+    }
+
+    // Objective coefficient of y_{ij,kl} (per matched copy)
+    double edgeCost(int ij, int kl) const {
+        return pb_->getCost(false, ij, kl) - edge_deletion_costs_[ij] - edge_insertion_costs_[kl];
     }
 
     void restrictProblem(double up) {
+        VariableStore& vars = lp_->getVariables();
+
         // Activate all variables (reset bounds).
         for (int i = 0; i < nVP; ++i) {
             for (int k = 0; k < nVT; ++k) {
-                x_variables.getElement(i, k)->activate();
+                vars.activate(xVar(i, k));
             }
         }
 
         for (int ij = 0; ij < nEP; ++ij) {
             for (int kl = 0; kl < nET; ++kl) {
-                y_variables.getElement(ij, kl)->activate();
+                vars.activate(yVar(ij, kl), 0, edgeCapacity(ij, kl));
+                if (!loopsCompatible(ij, kl)) {
+                    vars.deactivate(yVar(ij, kl));
+                }
             }
         }
 
@@ -162,13 +210,13 @@ private:
                 std::vector<double> v;
                 v.reserve(nVT);
                 for (int k = 0; k < nVT; ++k) {
-                    v.push_back(x_costs.getElement(i, k));
+                    v.push_back(vertexCost(i, k));
                 }
                 std::sort(v.begin(), v.end());
                 double threshold = v[static_cast<int>(std::floor(nVT * up))];
                 for (int k = 0; k < nVT; ++k) {
-                    if (x_costs.getElement(i, k) > threshold) {
-                        x_variables.getElement(i, k)->deactivate();
+                    if (vertexCost(i, k) > threshold) {
+                        vars.deactivate(xVar(i, k));
                     }
                 }
             }
@@ -178,28 +226,32 @@ private:
                 std::vector<double> v;
                 v.reserve(nVP);
                 for (int i = 0; i < nVP; ++i) {
-                    v.push_back(x_costs.getElement(i, k));
+                    v.push_back(vertexCost(i, k));
                 }
                 std::sort(v.begin(), v.end());
                 double threshold = v[static_cast<int>(std::floor(nVP * up))];
                 for (int i = 0; i < nVP; ++i) {
-                    if (x_costs.getElement(i, k) > threshold) {
-                        x_variables.getElement(i, k)->deactivate();
+                    if (vertexCost(i, k) > threshold) {
+                        vars.deactivate(xVar(i, k));
                     }
                 }
             }
 
             // Filter edge substitutions according to active vertex pairs and costs
             for (int ij = 0; ij < nEP; ++ij) {
-                int i = pb_->getQuery()->getEdge(ij)->getOrigin()->getIndex();
-                int j = pb_->getQuery()->getEdge(ij)->getTarget()->getIndex();
+                int i = pb_->getQuery()->getOrigin(ij);
+                int j = pb_->getQuery()->getTarget(ij);
                 for (int kl = 0; kl < nET; ++kl) {
-                    int k = pb_->getTarget()->getEdge(kl)->getOrigin()->getIndex();
-                    int l = pb_->getTarget()->getEdge(kl)->getTarget()->getIndex();
+                    int k = pb_->getTarget()->getOrigin(kl);
+                    int l = pb_->getTarget()->getTarget(kl);
                     // y_ij,kl must be 0 if the couple (x_i,k * x_j,l) is inactive
-                    if (!(x_variables.getElement(i, k)->isActive() &&
-                          x_variables.getElement(j, l)->isActive())) {
-                        y_variables.getElement(ij, kl)->deactivate();
+                    // (or, for undirected graphs, also the swapped couple (x_i,l * x_j,k))
+                    bool active = vars.isActive(xVar(i, k)) && vars.isActive(xVar(j, l));
+                    if (undirected_) {
+                        active = active || (vars.isActive(xVar(i, l)) && vars.isActive(xVar(j, k)));
+                    }
+                    if (!active) {
+                        vars.deactivate(yVar(ij, kl));
                     }
                 }
             }
@@ -209,81 +261,90 @@ private:
     void initConstraints() {
         // Each pattern vertex matched at most once
         for (int i = 0; i < nVP; ++i) {
-            auto* expr = new LinearExpression();
             for (int k = 0; k < nVT; ++k) {
-                expr->addTerm(x_variables.getElement(i, k), 1.0);
+                lp_->addTerm(xVar(i, k), 1.0);
             }
-            std::string id = "vertex_" + std::to_string(i);
-            auto* c = new LinearConstraint(id, expr, LinearConstraint::LESS_EQ, 1.0);
-            lp_->addConstraint(c);
+            lp_->addConstraint(ConstraintStore::LESS_EQ, 1.0);
         }
 
         // Each target vertex matched at most once
         for (int k = 0; k < nVT; ++k) {
-            auto* expr = new LinearExpression();
             for (int i = 0; i < nVP; ++i) {
-                expr->addTerm(x_variables.getElement(i, k), 1.0);
+                lp_->addTerm(xVar(i, k), 1.0);
             }
-            std::string id = "target_vertex_" + std::to_string(k);
-            auto* c = new LinearConstraint(id, expr, LinearConstraint::LESS_EQ, 1.0);
-            lp_->addConstraint(c);
+            lp_->addConstraint(ConstraintStore::LESS_EQ, 1.0);
         }
 
         // Each pattern edge matched at most once
         for (int ij = 0; ij < nEP; ++ij) {
-            auto* expr = new LinearExpression();
             for (int kl = 0; kl < nET; ++kl) {
-                expr->addTerm(y_variables.getElement(ij, kl), 1.0);
+                lp_->addTerm(yVar(ij, kl), 1.0);
             }
-            std::string id = "edge_" + std::to_string(ij);
-            auto* c = new LinearConstraint(id, expr, LinearConstraint::LESS_EQ, 1.0);
-            lp_->addConstraint(c);
+            double copies = pb_->getQuery()->getMultiplicity(ij);
+            lp_->addConstraint(ConstraintStore::LESS_EQ, copies);
         }
 
         // Each target edge matched at most once (symmetry for GED)
         for (int kl = 0; kl < nET; ++kl) {
-            auto* expr = new LinearExpression();
             for (int ij = 0; ij < nEP; ++ij) {
-                expr->addTerm(y_variables.getElement(ij, kl), 1.0);
+                lp_->addTerm(yVar(ij, kl), 1.0);
             }
-            std::string id = "target_edge_" + std::to_string(kl);
-            auto* c = new LinearConstraint(id, expr, LinearConstraint::LESS_EQ, 1.0);
-            lp_->addConstraint(c);
+            double copies = pb_->getTarget()->getMultiplicity(kl);
+            lp_->addConstraint(ConstraintStore::LESS_EQ, copies);
         }
 
-        // Edge consistency constraints (F2)
+        // Edge consistency constraints (F2), unless EdgeConsistency separates them on demand
+        if (!lazy_edges_) {
+            if (undirected_) {
+                initUndirectedEdgeConstraints();
+            } else {
+                initDirectedEdgeConstraints();
+            }
+        }
+    }
+
+    // Copies of ij may only go to edges leaving x(i) / entering x(j)
+    void initDirectedEdgeConstraints() {
+        const Graph* t = pb_->getTarget();
         for (int ij = 0; ij < nEP; ++ij) {
-            int i = pb_->getQuery()->getEdge(ij)->getOrigin()->getIndex();
-            int j = pb_->getQuery()->getEdge(ij)->getTarget()->getIndex();
+            int i = pb_->getQuery()->getOrigin(ij);
+            int j = pb_->getQuery()->getTarget(ij);
+            double copies = pb_->getQuery()->getMultiplicity(ij);
 
             for (int k = 0; k < nVT; ++k) {
-                auto* e1 = new LinearExpression();
-                auto* e2 = new LinearExpression();
+                // Out-row: sum of y_ij,kl over edges kl leaving k <= copies * x_ik
+                lp_->addTerm(xVar(i, k), -copies);
+                for (int kl : t->getOutEdges(k)) lp_->addTerm(yVar(ij, kl), 1.0);
+                lp_->addConstraint(ConstraintStore::LESS_EQ, 0.0);
+
+                // In-row: sum of y_ij,kl over edges kl entering k <= copies * x_jk
+                lp_->addTerm(xVar(j, k), -copies);
+                for (int kl : t->getInEdges(k)) lp_->addTerm(yVar(ij, kl), 1.0);
+                lp_->addConstraint(ConstraintStore::LESS_EQ, 0.0);
+            }
+        }
+    }
 
-                for (int kl = 0; kl < nET; ++kl) {
-                    Edge* target_edge = pb_->getTarget()->getEdge(kl);
-                    int k_out = target_edge->getOrigin()->getIndex();
-                    int k_in = target_edge->getTarget()->getIndex();
+    // Edges incident to k may receive copies of {i,j} only if i or j is mapped to k
+    void initUndirectedEdgeConstraints() {
+        const Graph* t = pb_->getTarget();
+        for (int ij = 0; ij < nEP; ++ij) {
+            int i = pb_->getQuery()->getOrigin(ij);
+            int j = pb_->getQuery()->getTarget(ij);
+            double copies = pb_->getQuery()->getMultiplicity(ij);
 
-                    if (k_out == k) {
-                        e1->addTerm(y_variables.getElement(ij, kl), 1.0);
-                    }
-                    if (k_in == k) {
-                        e2->addTerm(y_variables.getElement(ij, kl), 1.0);
-                    }
+            for (int k = 0; k < nVT; ++k) {
+                lp_->addTerm(xVar(i, k), -copies);
+                if (j != i) {
+                    lp_->addTerm(xVar(j, k), -copies);
                 }
-
-                e1->addTerm(x_variables.getElement(i, k), -1.0);
-                e2->addTerm(x_variables.getElement(j, k), -1.0);
-
-                std::string id1 = "edge_cons_" + std::to_string(ij) + "_" + std::to_string(k) + "_out";
-                std::string id2 = "edge_cons_" + std::to_string(ij) + "_" + std::to_string(k) + "_in";
-
-                auto* c1 = new LinearConstraint(id1, e1, LinearConstraint::LESS_EQ, 0.0);
-                auto* c2 = new LinearConstraint(id2, e2, LinearConstraint::LESS_EQ, 0.0);
-
-                lp_->addConstraint(c1);
-                lp_->addConstraint(c2);
+                // Edges {u,k} with u <= k, then {k,l} with l >= k: ascending edge indices.
+                // A self-loop {k,k} is in both lists and only taken from the second.
+                for (int kl : t->getInEdges(k)) {
+                    if (t->getOrigin(kl) != k) lp_->addTerm(yVar(ij, kl), 1.0);
+                }
+                for (int kl : t->getOutEdges(k)) lp_->addTerm(yVar(ij, kl), 1.0);
+                lp_->addConstraint(ConstraintStore::LESS_EQ, 0.0);
             }
         }
     }
@@ -293,26 +354,26 @@ private:
 
         for (int i = 0; i < nVP; ++i) {
             for (int k = 0; k < nVT; ++k) {
-                double coeff = x_costs.getElement(i, k);
+                double coeff = vertexCost(i, k);
                 if (std::abs(coeff) > precision_) {
-                    obj->addTerm(x_variables.getElement(i, k), coeff);
+                    obj->addTerm(xVar(i, k), coeff);
                 }
             }
         }
 
         for (int ij = 0; ij < nEP; ++ij) {
             for (int kl = 0; kl < nET; ++kl) {
-                double coeff = y_costs.getElement(ij, kl);
+                double coeff = edgeCost(ij, kl);
                 if (std::abs(coeff) > precision_) {
-                    obj->addTerm(y_variables.getElement(ij, kl), coeff);
+                    obj->addTerm(yVar(ij, kl), coeff);
                 }
             }
         }
 
         double constant = vertex_deletion_cost_ * nVP +
                           vertex_insertion_cost_ * nVT +
-                          edge_deletion_cost_ * nEP +
-                          edge_insertion_cost_ * nET;
+                          edge_deletion_cost_ * pb_->getQuery()->getTotalArcMultiplicity() +
+                          edge_insertion_cost_ * pb_->getTarget()->getTotalArcMultiplicity();
         obj->setConstant(constant);
         lp_->setObjective(obj);
     }
@@ -320,6 +381,8 @@ private:
     Problem* pb_;
     LinearProgram* lp_;
     bool relaxed_;
+    bool undirected_;
+    bool lazy_edges_;  // F2 rows left out of the model
     double precision_;
     double vertex_insertion_cost_;
     double vertex_deletion_cost_;
@@ -328,10 +391,9 @@ private:
 
     int nVP, nVT, nEP, nET;
 
-    Matrix<Variable*> x_variables;
-    Matrix<Variable*> y_variables;
-    Matrix<double> x_costs;
-    Matrix<double> y_costs;
+    MatchingLayout layout_;
+    std::vector<double> edge_deletion_costs_;   // per pattern edge copy
+    std::vector<double> edge_insertion_costs_;  // per target edge copy
 };
 
 } // namespace gempp
@@ -0,0 +1,85 @@
+#ifndef V2_MATCHING_LAYOUT_H
+#define V2_MATCHING_LAYOUT_H
+
+#include "../core/types.h"
+#include "../model/problem.h"
+#include <climits>
+#include <string>
+#include <utility>
+
+namespace gempp {
+
+// Column layout shared by the matching formulations and their consumers.
+//
+// x_{i,k} (pattern vertex i -> target vertex k) occupies column i * nVT + k, and
+// y_{ij,kl} (copies of pattern edge ij matched onto target edge kl) occupies column
+// nVP * nVT + ij * nET + kl. Formulations create their columns in exactly this order,
+// so a column index is all that is needed to identify a variable.
+class MatchingLayout {
+public:
+    MatchingLayout() : nVP_(0), nVT_(0), nEP_(0), nET_(0) {}
+
+    // Throws if the columns do not fit an int (GLPK's column numbers)
+    explicit MatchingLayout(const Problem* pb)
+        : nVP_(pb->getQuery()->getVertexCount()), nVT_(pb->getTarget()->getVertexCount()),
+          nEP_(pb->getQuery()->getEdgeCount()), nET_(pb->getTarget()->getEdgeCount())
+    {
+        long long columns = static_cast<long long>(nVP_) * nVT_ + static_cast<long long>(nEP_) * nET_;
+        if (columns > INT_MAX) {
+            throw Exception("The model would have " + std::to_string(columns) +
+                            " columns, more than the " + std::to_string(INT_MAX) +
+                            " an ILP can hold (--mcs, --bipartite and --fast build none)");
+        }
+    }
+
+    int x(int i, int k) const { return static_cast<int>(static_cast<long long>(i) * nVT_ + k); }
+    int y(int ij, int kl) const {
+        return static_cast<int>(yBegin() + static_cast<long long>(ij) * nET_ + kl);
+    }
+
+    int yBegin() const { return static_cast<int>(static_cast<long long>(nVP_) * nVT_); }
+    int size() const { return static_cast<int>(yBegin() + static_cast<long long>(nEP_) * nET_); }
+
+    bool isX(int col) const { return col < yBegin(); }
+
+    // (i, k) of an x column, or (ij, kl) of a y column
+    std::pair<int, int> decode(int col) const {
+        if (isX(col)) return {col / nVT_, col % nVT_};
+        col -= yBegin();
+        return {col / nET_, col % nET_};
+    }
+
+    std::string name(int col) const {
+        std::pair<int, int> p = decode(col);
+        return (isX(col) ? "x_" : "y_") + std::to_string(p.first) + "," + std::to_string(p.second);
+    }
+
+    // Column of a name produced by name(), or -1 if it is not one
+    int column(const std::string& name) const {
+        if (name.size() < 2 || (name[0] != 'x' && name[0] != 'y') || name[1] != '_') return -1;
+        size_t pos = 2;
+        int a = readIndex(name, pos);
+        if (a < 0 || pos >= name.size() || name[pos++] != ',') return -1;
+        int b = readIndex(name, pos);
+        if (b < 0 || pos != name.size()) return -1;
+        if (name[0] == 'x') return (a < nVP_ && b < nVT_) ? x(a, b) : -1;
+        return (a < nEP_ && b < nET_) ? y(a, b) : -1;
+    }
+
+private:
+    // Non-negative decimal index at name[pos], advancing pos past it (-1 if none)
+    static int readIndex(const std::string& name, size_t& pos) {
+        size_t begin = pos;
+        long value = 0;
+        while (pos < name.size() && name[pos] >= '0' && name[pos] <= '9' && value <= INT_MAX) {
+            value = value * 10 + (name[pos++] - '0');
+        }
+        return (pos == begin || value > INT_MAX) ? -1 : static_cast<int>(value);
+    }
+
+    int nVP_, nVT_, nEP_, nET_;
+};
+
+} // namespace gempp
+
+#endif // V2_MATCHING_LAYOUT_H
@@ -4,7 +4,8 @@
 #include "../model/problem.h"
 #include "../model/graph.h"
 #include "../integer_programming/linear_program.h"
-#include "../core/matrix.h"
+#include "bound_provider.h"
+#include "matching_layout.h"
 #include <vector>
 #include <unordered_map>
 #include <algorithm>
@@ -15,10 +16,19 @@ namespace gempp {
 // Minimum Cost Subgraph Matching (MCSM) Formulation
 // This allows partial matches - pattern elements can be unmatched (with cost)
 // The objective is the "minimal extension" - cost of unmatched pattern elements
+//
+// Edges carrying a multiplicity m > 1 (Graph::getMultiplicity) stand for m parallel edges:
+// y_ij,kl is then a bounded integer in [0, min(m_ij, m_kl)] counting matched copies, and
+// costs apply per copy. The optimum equals that of the expanded multigraph.
+//
+// For UNDIRECTED graphs each edge {i,j} is one variable row and the F2 rows use vertex
+// incidence (one row per pattern edge and target vertex instead of two). Creation costs are
+// counted per arc (2 for an edge, 1 for a self-loop), so objectives match the directed model
+// of the same symmetric matrices.
 class MinimumCostSubgraphMatching {
 public:
     MinimumCostSubgraphMatching(Problem* pb, bool induced = false)
-        : pb_(pb), lp_(nullptr), induced_(induced)
+        : pb_(pb), lp_(nullptr), induced_(induced), undirected_(false), lazy_edges_(false)
     {
         precision_ = 1e-9;
         // Default creation cost for unlabeled elements
@@ -29,14 +39,21 @@ public:
         delete lp_;
     }
 
-    void init(double /* up */ = 1.0) {
+    // Build the linear program. With a sink, constraints go to it instead of the program.
+    void init(double /* up */ = 1.0, RowSink* sink = nullptr) {
         lp_ = new LinearProgram(LinearProgram::MINIMIZE);
+        lp_->setRowSink(sink);
 
         nVP = pb_->getQuery()->getVertexCount();
         nVT = pb_->getTarget()->getVertexCount();
         nEP = pb_->getQuery()->getEdgeCount();
         nET = pb_->getTarget()->getEdgeCount();
 
+        if (pb_->getQuery()->isDirected() != pb_->getTarget()->isDirected()) {
+            throw Exception("Pattern and target graphs must be both directed or both undirected");
+        }
+        undirected_ = !pb_->getQuery()->isDirected();
+
         initVariables();
         initCosts();
         initConstraints();
@@ -44,161 +61,185 @@ public:
     }
 
     LinearProgram* getLinearProgram() { return lp_; }
-    const Matrix<Variable*>& getXVariables() const { return x_variables; }
-    const Matrix<Variable*>& getYVariables() const { return y_variables; }
+    const MatchingLayout& getLayout() const { return layout_; }
+
+    // Build the model without the F2 edge consistency rows, which EdgeConsistency then
+    // separates on demand (must be called before init)
+    void setLazyEdgeConstraints(bool lazy) { lazy_edges_ = lazy; }
+
+    // Combinatorial lower bounds on the minimal extension (no init() needed)
+    void addBoundProviders(LowerBounds& bounds) const {
+        EditCosts costs = {default_creation_cost_, 0.0, default_creation_cost_, 0.0};
+        bounds.add(std::unique_ptr<BoundProvider>(new CardinalityBound(pb_, costs)));
+        bounds.add(std::unique_ptr<BoundProvider>(new DegreeSequenceBound(pb_, costs)));
+    }
 
     // Get creation costs for extracting unmatched elements
     double getVertexCreationCost(int i) const { return vertex_creation_costs_[i]; }
     double getEdgeCreationCost(int ij) const { return edge_creation_costs_[ij]; }
 
 private:
+    // Number of parallel copies pattern edge ij and target edge kl can share
+    int edgeCapacity(int ij, int kl) const {
+        return std::min(pb_->getQuery()->getMultiplicity(ij), pb_->getTarget()->getMultiplicity(kl));
+    }
+
+    // Undirected self-loops can only be matched onto self-loops (F2 uses vertex incidence,
+    // which cannot tell a loop from an edge with one mapped endpoint)
+    bool loopsCompatible(int ij, int kl) const {
+        if (!undirected_) return true;
+        const Graph* q = pb_->getQuery();
+        const Graph* t = pb_->getTarget();
+        return (q->getOrigin(ij) == q->getTarget(ij)) == (t->getOrigin(kl) == t->getTarget(kl));
+    }
+
+    // Column indices of x_{i,k} and y_{ij,kl}
+    int xVar(int i, int k) const { return layout_.x(i, k); }
+    int yVar(int ij, int kl) const { return layout_.y(ij, kl); }
+
     void initVariables() {
-        x_variables = Matrix<Variable*>(nVP, nVT);
+        // Columns follow MatchingLayout: all x_{i,k}, then all y_{ij,kl}, row-major
+        layout_ = MatchingLayout(pb_);
+        VariableStore& vars = lp_->getVariables();
+        vars.reserve(layout_.size());
+        vars.setNamer([layout = layout_](int col) { return layout.name(col); });
+
         for (int i = 0; i < nVP; ++i) {
             for (int k = 0; k < nVT; ++k) {
-                std::string id = "x_" + std::to_string(i) + "," + std::to_string(k);
-                Variable* v = new Variable(id, Variable::BINARY);
-                x_variables.setElement(i, k, v);
-                lp_->addVariable(v);
+                lp_->addVariable(VariableStore::BINARY);
             }
         }
 
-        y_variables = Matrix<Variable*>(nEP, nET);
         for (int ij = 0; ij < nEP; ++ij) {
             for (int kl = 0; kl < nET; ++kl) {
-                std::string id = "y_" + std::to_string(ij) + "," + std::to_string(kl);
-                Variable* v = new Variable(id, Variable::BINARY);
-                y_variables.setElement(ij, kl, v);
-                lp_->addVariable(v);
+                int cap = edgeCapacity(ij, kl);
+                int col = (cap > 1) ? lp_->addVariable(VariableStore::BOUNDED, 0, cap)
+                                    : lp_->addVariable(VariableStore::BINARY);
+                if (!loopsCompatible(ij, kl)) vars.deactivate(col);
             }
         }
     }
 
     void initCosts() {
-        // Initialize substitution cost matrices
-        x_costs = Matrix<double>(nVP, nVT);
-        for (int i = 0; i < nVP; ++i) {
-            for (int k = 0; k < nVT; ++k) {
-                x_costs.setElement(i, k, pb_->getCost(true, i, k));
-            }
-        }
-
-        y_costs = Matrix<double>(nEP, nET);
+        // Initialize creation costs (cost of NOT matching an element, per parallel copy).
+        // Substitution costs are not copied: they are read from the Problem's cost tables.
+        vertex_creation_costs_.resize(nVP, default_creation_cost_);
+        edge_creation_costs_.resize(nEP);
         for (int ij = 0; ij < nEP; ++ij) {
-            for (int kl = 0; kl < nET; ++kl) {
-                y_costs.setElement(ij, kl, pb_->getCost(false, ij, kl));
-            }
+            const Graph* q = pb_->getQuery();
+            edge_creation_costs_[ij] = default_creation_cost_ * q->getArcMultiplicity(ij) /
+                                       q->getMultiplicity(ij);
         }
-
-        // Initialize creation costs (cost of NOT matching an element)
-        vertex_creation_costs_.resize(nVP, default_creation_cost_);
-        edge_creation_costs_.resize(nEP, default_creation_cost_);
     }
 
     void initConstraints() {
         // Constraint 1: Each pattern vertex maps to AT MOST one target vertex
         // (LESS_EQ instead of EQUAL - allows unmatched pattern vertices)
         for (int i = 0; i < nVP; ++i) {
-            LinearExpression* expr = new LinearExpression();
             for (int k = 0; k < nVT; ++k) {
-                expr->addTerm(x_variables.getElement(i, k), 1.0);
+                lp_->addTerm(xVar(i, k), 1.0);
             }
-            std::string id = "vertex_" + std::to_string(i);
-            auto* c = new LinearConstraint(id, expr, LinearConstraint::LESS_EQ, 1.0);
-            lp_->addConstraint(c);
+            lp_->addConstraint(ConstraintStore::LESS_EQ, 1.0);
         }
 
         // Constraint 2: Each target vertex maps to at most one pattern vertex
         for (int k = 0; k < nVT; ++k) {
-            LinearExpression* expr = new LinearExpression();
             for (int i = 0; i < nVP; ++i) {
-                expr->addTerm(x_variables.getElement(i, k), 1.0);
+                lp_->addTerm(xVar(i, k), 1.0);
             }
-            std::string id = "target_vertex_" + std::to_string(k);
-            auto* c = new LinearConstraint(id, expr, LinearConstraint::LESS_EQ, 1.0);
-            lp_->addConstraint(c);
+            lp_->addConstraint(ConstraintStore::LESS_EQ, 1.0);
         }
 
         // Constraint 3: Each pattern edge maps to AT MOST one target edge
         // (LESS_EQ instead of EQUAL - allows unmatched pattern edges)
         for (int ij = 0; ij < nEP; ++ij) {
-            LinearExpression* expr = new LinearExpression();
             for (int kl = 0; kl < nET; ++kl) {
-                expr->addTerm(y_variables.getElement(ij, kl), 1.0);
+                lp_->addTerm(yVar(ij, kl), 1.0);
             }
-            std::string id = "edge_" + std::to_string(ij);
-            auto* c = new LinearConstraint(id, expr, LinearConstraint::LESS_EQ, 1.0);
-            lp_->addConstraint(c);
+            lp_->addConstraint(ConstraintStore::LESS_EQ, pb_->getQuery()->getMultiplicity(ij));
         }
 
         // Constraint 3b: Each target edge can receive at most one pattern edge (multigraph multiplicity)
         for (int kl = 0; kl < nET; ++kl) {
-            LinearExpression* expr = new LinearExpression();
             for (int ij = 0; ij < nEP; ++ij) {
-                expr->addTerm(y_variables.getElement(ij, kl), 1.0);
+                lp_->addTerm(yVar(ij, kl), 1.0);
             }
-            std::string id = "target_edge_" + std::to_string(kl);
-            auto* c = new LinearConstraint(id, expr, LinearConstraint::LESS_EQ, 1.0);
-            lp_->addConstraint(c);
+            lp_->addConstraint(ConstraintStore::LESS_EQ, pb_->getTarget()->getMultiplicity(kl));
         }
 
-        // Constraint 4 (F2): Edge consistency constraints
-        for (int ij = 0; ij < nEP; ++ij) {
-            int i = pb_->getQuery()->getEdge(ij)->getOrigin()->getIndex();
-            int j = pb_->getQuery()->getEdge(ij)->getTarget()->getIndex();
-
-            for (int k = 0; k < nVT; ++k) {
-                LinearExpression* e1 = new LinearExpression();
-                LinearExpression* e2 = new LinearExpression();
-
-                for (int kl = 0; kl < nET; ++kl) {
-                    Edge* target_edge = pb_->getTarget()->getEdge(kl);
-                    int k_out = target_edge->getOrigin()->getIndex();
-                    int k_in = target_edge->getTarget()->getIndex();
-
-                    if (k_out == k) {
-                        e1->addTerm(y_variables.getElement(ij, kl), 1.0);
-                    }
-                    if (k_in == k) {
-                        e2->addTerm(y_variables.getElement(ij, kl), 1.0);
-                    }
-                }
-
-                e1->addTerm(x_variables.getElement(i, k), -1.0);
-                e2->addTerm(x_variables.getElement(j, k), -1.0);
-
-                std::string id1 = "edge_cons_" + std::to_string(ij) + "_" + std::to_string(k) + "_out";
-                std::string id2 = "edge_cons_" + std::to_string(ij) + "_" + std::to_string(k) + "_in";
-
-                auto* c1 = new LinearConstraint(id1, e1, LinearConstraint::LESS_EQ, 0.0);
-                auto* c2 = new LinearConstraint(id2, e2, LinearConstraint::LESS_EQ, 0.0);
-
-                lp_->addConstraint(c1);
-                lp_->addConstraint(c2);
+        // Constraint 4 (F2): Edge consistency constraints (unless separated on demand, see
+        // EdgeConsistency)
+        if (!lazy_edges_) {
+            if (undirected_) {
+                initUndirectedEdgeConstraints();
+            } else {
+                initDirectedEdgeConstraints();
             }
         }
 
         // Constraint 5: Induced subgraph constraints (if required)
         if (induced_) {
             for (int kl = 0; kl < nET; ++kl) {
-                int k = pb_->getTarget()->getEdge(kl)->getOrigin()->getIndex();
-                int l = pb_->getTarget()->getEdge(kl)->getTarget()->getIndex();
-
-                LinearExpression* expr = new LinearExpression();
+                int k = pb_->getTarget()->getOrigin(kl);
+                int l = pb_->getTarget()->getTarget(kl);
 
                 for (int i = 0; i < nVP; ++i) {
-                    expr->addTerm(x_variables.getElement(i, k), 1.0);
+                    lp_->addTerm(xVar(i, k), 1.0);
                 }
                 for (int i = 0; i < nVP; ++i) {
-                    expr->addTerm(x_variables.getElement(i, l), 1.0);
+                    lp_->addTerm(xVar(i, l), 1.0);
                 }
                 for (int ij = 0; ij < nEP; ++ij) {
-                    expr->addTerm(y_variables.getElement(ij, kl), -1.0);
+                    lp_->addTerm(yVar(ij, kl), -1.0);
                 }
+                lp_->addConstraint(ConstraintStore::LESS_EQ, 1.0);
+            }
+        }
+    }
+
+    // F2 for directed graphs: copies of ij may only go to edges leaving x(i) / entering x(j)
+    void initDirectedEdgeConstraints() {
+        const Graph* t = pb_->getTarget();
+        for (int ij = 0; ij < nEP; ++ij) {
+            int i = pb_->getQuery()->getOrigin(ij);
+            int j = pb_->getQuery()->getTarget(ij);
+            double copies = pb_->getQuery()->getMultiplicity(ij);
+
+            for (int k = 0; k < nVT; ++k) {
+                // Out-row: sum of y_ij,kl over edges kl leaving k <= copies * x_ik
+                lp_->addTerm(xVar(i, k), -copies);
+                for (int kl : t->getOutEdges(k)) lp_->addTerm(yVar(ij, kl), 1.0);
+                lp_->addConstraint(ConstraintStore::LESS_EQ, 0.0);
+
+                // In-row: sum of y_ij,kl over edges kl entering k <= copies * x_jk
+                lp_->addTerm(xVar(j, k), -copies);
+                for (int kl : t->getInEdges(k)) lp_->addTerm(yVar(ij, kl), 1.0);
+                lp_->addConstraint(ConstraintStore::LESS_EQ, 0.0);
+            }
+        }
+    }
 
-                std::string id = "induced_" + std::to_string(kl);
-                auto* c = new LinearConstraint(id, expr, LinearConstraint::LESS_EQ, 1.0);
-                lp_->addConstraint(c);
+    // F2 for undirected graphs: edges incident to k may receive copies of {i,j} only if
+    // i or j is mapped to k
+    void initUndirectedEdgeConstraints() {
+        const Graph* t = pb_->getTarget();
+        for (int ij = 0; ij < nEP; ++ij) {
+            int i = pb_->getQuery()->getOrigin(ij);
+            int j = pb_->getQuery()->getTarget(ij);
+            double copies = pb_->getQuery()->getMultiplicity(ij);
+
+            for (int k = 0; k < nVT; ++k) {
+                lp_->addTerm(xVar(i, k), -copies);
+                if (j != i) {
+                    lp_->addTerm(xVar(j, k), -copies);
+                }
+                // Edges {u,k} with u <= k, then {k,l} with l >= k: ascending edge indices.
+                // A self-loop {k,k} is in both lists and only taken from the second.
+                for (int kl : t->getInEdges(k)) {
+                    if (t->getOrigin(kl) != k) lp_->addTerm(yVar(ij, kl), 1.0);
+                }
+                for (int kl : t->getOutEdges(k)) lp_->addTerm(yVar(ij, kl), 1.0);
+                lp_->addConstraint(ConstraintStore::LESS_EQ, 0.0);
             }
         }
     }
@@ -217,31 +258,33 @@ private:
             constant += vertex_creation_costs_[i];
         }
         for (int ij = 0; ij < nEP; ++ij) {
-            constant += edge_creation_costs_[ij];
+            constant += edge_creation_costs_[ij] * pb_->getQuery()->getMultiplicity(ij);
         }
         obj->setConstant(constant);
 
         // Add vertex terms: (substitution_cost - creation_cost) * x_ik
         // When x_ik = 1 (matched), we add substitution_cost and subtract creation_cost
+        const CostTable& vertexCosts = pb_->getCostTable(true);
         for (int i = 0; i < nVP; ++i) {
             for (int k = 0; k < nVT; ++k) {
-                double sub_cost = x_costs.getElement(i, k);
+                double sub_cost = vertexCosts.get(i, k);
                 double create_cost = vertex_creation_costs_[i];
                 double coeff = sub_cost - create_cost;
                 if (std::abs(coeff) > precision_) {
-                    obj->addTerm(x_variables.getElement(i, k), coeff);
+                    obj->addTerm(xVar(i, k), coeff);
                 }
             }
         }
 
-        // Add edge terms: (substitution_cost - creation_cost) * y_ij_kl
+        // Add edge terms: (substitution_cost - creation_cost) * y_ij_kl (per matched copy)
+        const CostTable& edgeCosts = pb_->getCostTable(false);
         for (int ij = 0; ij < nEP; ++ij) {
             for (int kl = 0; kl < nET; ++kl) {
-                double sub_cost = y_costs.getElement(ij, kl);
+                double sub_cost = edgeCosts.get(ij, kl);
                 double create_cost = edge_creation_costs_[ij];
                 double coeff = sub_cost - create_cost;
                 if (std::abs(coeff) > precision_) {
-                    obj->addTerm(y_variables.getElement(ij, kl), coeff);
+                    obj->addTerm(yVar(ij, kl), coeff);
                 }
             }
         }
@@ -252,15 +295,14 @@ private:
     Problem* pb_;
     LinearProgram* lp_;
     bool induced_;
+    bool undirected_;
+    bool lazy_edges_;  // F2 rows left out of the model
     double precision_;
     double default_creation_cost_;
 
     int nVP, nVT, nEP, nET;
 
-    Matrix<Variable*> x_variables;
-    Matrix<Variable*> y_variables;
-    Matrix<double> x_costs;
-    Matrix<double> y_costs;
+    MatchingLayout layout_;
 
     std::vector<double> vertex_creation_costs_;
     std::vector<double> edge_creation_costs_;
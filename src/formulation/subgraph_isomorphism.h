@@ -4,7 +4,7 @@
 #include "../model/problem.h"
 #include "../model/graph.h"
 #include "../integer_programming/linear_program.h"
-#include "../core/matrix.h"
+#include "matching_layout.h"
 #include <vector>
 #include <unordered_map>
 #include <algorithm>
@@ -27,9 +27,10 @@ public:
     }
 
     // Initialize the formulation
-    void init(double up = 1.0) {
-        // Create linear program
+    void init(double up = 1.0, RowSink* sink = nullptr) {
+        // Create linear program (constraints go to sink if given)
         lp_ = new LinearProgram(LinearProgram::MINIMIZE);
+        lp_->setRowSink(sink);
 
         // Set up problem dimensions
         nVP = pb_->getQuery()->getVertexCount();
@@ -39,7 +40,6 @@ public:
 
         // Initialize all components
         initVariables();
-        initCosts();
         restrictProblem(up);
         initConstraints();
         initObjective();
@@ -48,52 +48,47 @@ public:
     LinearProgram* getLinearProgram() { return lp_; }
 
     // Get variable mapping for solution extraction
-    const Matrix<Variable*>& getXVariables() const { return x_variables; }
-    const Matrix<Variable*>& getYVariables() const { return y_variables; }
+    const MatchingLayout& getLayout() const { return layout_; }
 
 private:
-    void initVariables() {
-        // Create x variables (vertex matching): x[i][k] = 1 if vertex i maps to k
-        x_variables = Matrix<Variable*>(nVP, nVT);
-        for (int i = 0; i < nVP; ++i) {
-            for (int k = 0; k < nVT; ++k) {
-                std::string id = "x_" + std::to_string(i) + "," + std::to_string(k);
-                Variable* v = new Variable(id, Variable::BINARY);
-                x_variables.setElement(i, k, v);
-                lp_->addVariable(v);
-            }
-        }
-
-        // Create y variables (edge matching): y[ij][kl] = 1 if edge ij maps to kl
-        y_variables = Matrix<Variable*>(nEP, nET);
-        for (int ij = 0; ij < nEP; ++ij) {
-            for (int kl = 0; kl < nET; ++kl) {
-                std::string id = "y_" + std::to_string(ij) + "," + std::to_string(kl);
-                Variable* v = new Variable(id, Variable::BINARY);
-                y_variables.setElement(ij, kl, v);
-                lp_->addVariable(v);
-            }
-        }
+    // Number of parallel copies pattern edge ij and target edge kl can share
+    int edgeCapacity(int ij, int kl) const {
+        return std::min(pb_->getQuery()->getMultiplicity(ij), pb_->getTarget()->getMultiplicity(kl));
     }
 
-    void initCosts() {
-        // Initialize cost matrices from problem
-        x_costs = Matrix<double>(nVP, nVT);
+    // Column indices of x_{i,k} and y_{ij,kl}
+    int xVar(int i, int k) const { return layout_.x(i, k); }
+    int yVar(int ij, int kl) const { return layout_.y(ij, kl); }
+
+    void initVariables() {
+        // Columns follow MatchingLayout: x_{i,k} = 1 if vertex i maps to k, then
+        // y_{ij,kl} = copies of edge ij mapped onto kl
+        layout_ = MatchingLayout(pb_);
+        VariableStore& vars = lp_->getVariables();
+        vars.reserve(layout_.size());
+        vars.setNamer([layout = layout_](int col) { return layout.name(col); });
+
         for (int i = 0; i < nVP; ++i) {
             for (int k = 0; k < nVT; ++k) {
-                x_costs.setElement(i, k, pb_->getCost(true, i, k));
+                lp_->addVariable(VariableStore::BINARY);
             }
         }
 
-        y_costs = Matrix<double>(nEP, nET);
         for (int ij = 0; ij < nEP; ++ij) {
             for (int kl = 0; kl < nET; ++kl) {
-                y_costs.setElement(ij, kl, pb_->getCost(false, ij, kl));
+                int cap = edgeCapacity(ij, kl);
+                if (cap > 1) {
+                    lp_->addVariable(VariableStore::BOUNDED, 0, cap);
+                } else {
+                    lp_->addVariable(VariableStore::BINARY);
+                }
             }
         }
     }
 
     void restrictProblem(double up) {
+        VariableStore& vars = lp_->getVariables();
+
         // For exact subgraph isomorphism (up == 1.0):
         // Deactivate variables where cost > precision
         if (up < 1) {
@@ -103,41 +98,48 @@ private:
         // Activate all variables first
         for (int i = 0; i < nVP; ++i) {
             for (int k = 0; k < nVT; ++k) {
-                x_variables.getElement(i, k)->activate();
+                vars.activate(xVar(i, k));
             }
         }
 
         for (int ij = 0; ij < nEP; ++ij) {
             for (int kl = 0; kl < nET; ++kl) {
-                y_variables.getElement(ij, kl)->activate();
+                vars.activate(yVar(ij, kl), 0, edgeCapacity(ij, kl));
             }
         }
 
         // Deactivate vertex variables with high cost
+        const CostTable& vertexCosts = pb_->getCostTable(true);
         for (int i = 0; i < nVP; ++i) {
             for (int k = 0; k < nVT; ++k) {
-                if (x_costs.getElement(i, k) > precision_) {
-                    x_variables.getElement(i, k)->deactivate();
+                if (vertexCosts.get(i, k) > precision_) {
+                    vars.deactivate(xVar(i, k));
                 }
             }
         }
 
         // Deactivate edge variables based on vertex variables and cost
+        const CostTable& edgeCosts = pb_->getCostTable(false);
         for (int ij = 0; ij < nEP; ++ij) {
-            int i = pb_->getQuery()->getEdge(ij)->getOrigin()->getIndex();
-            int j = pb_->getQuery()->getEdge(ij)->getTarget()->getIndex();
+            int i = pb_->getQuery()->getOrigin(ij);
+            int j = pb_->getQuery()->getTarget(ij);
 
             for (int kl = 0; kl < nET; ++kl) {
-                if (y_costs.getElement(ij, kl) > precision_) {
-                    y_variables.getElement(ij, kl)->deactivate();
+                if (edgeCosts.get(ij, kl) > precision_) {
+                    vars.deactivate(yVar(ij, kl));
                 } else {
-                    int k = pb_->getTarget()->getEdge(kl)->getOrigin()->getIndex();
-                    int l = pb_->getTarget()->getEdge(kl)->getTarget()->getIndex();
-
-                    // y_ij,kl must be 0 if (x_i,k * x_j,l) is inactive
-                    if (!(x_variables.getElement(i, k)->isActive() &&
-                          x_variables.getElement(j, l)->isActive())) {
-                        y_variables.getElement(ij, kl)->deactivate();
+                    int k = pb_->getTarget()->getOrigin(kl);
+                    int l = pb_->getTarget()->getTarget(kl);
+
+                    // y_ij,kl must be 0 if (x_i,k * x_j,l) is inactive; undirected edges may
+                    // also map swapped, and self-loops only onto self-loops
+                    bool active = vars.isActive(xVar(i, k)) && vars.isActive(xVar(j, l));
+                    if (!pb_->getQuery()->isDirected()) {
+                        active = (active || (vars.isActive(xVar(i, l)) && vars.isActive(xVar(j, k)))) &&
+                             ((i == j) == (k == l));
+                    }
+                    if (!active) {
+                        vars.deactivate(yVar(ij, kl));
                     }
                 }
             }
@@ -147,100 +149,86 @@ private:
     void initConstraints() {
         // Constraint 1: Each pattern vertex maps to exactly one target vertex
         for (int i = 0; i < nVP; ++i) {
-            LinearExpression* expr = new LinearExpression();
             for (int k = 0; k < nVT; ++k) {
-                expr->addTerm(x_variables.getElement(i, k), 1.0);
+                lp_->addTerm(xVar(i, k), 1.0);
             }
-            std::string id = "vertex_" + std::to_string(i);
-            auto* c = new LinearConstraint(id, expr, LinearConstraint::EQUAL, 1.0);
-            lp_->addConstraint(c);
+            lp_->addConstraint(ConstraintStore::EQUAL, 1.0);
         }
 
         // Constraint 2: Each target vertex maps to at most one pattern vertex
         for (int k = 0; k < nVT; ++k) {
-            LinearExpression* expr = new LinearExpression();
             for (int i = 0; i < nVP; ++i) {
-                expr->addTerm(x_variables.getElement(i, k), 1.0);
+                lp_->addTerm(xVar(i, k), 1.0);
             }
-            std::string id = "target_vertex_" + std::to_string(k);
-            auto* c = new LinearConstraint(id, expr, LinearConstraint::LESS_EQ, 1.0);
-            lp_->addConstraint(c);
+            lp_->addConstraint(ConstraintStore::LESS_EQ, 1.0);
         }
 
         // Constraint 3: Each pattern edge maps to exactly one target edge
         for (int ij = 0; ij < nEP; ++ij) {
-            LinearExpression* expr = new LinearExpression();
             for (int kl = 0; kl < nET; ++kl) {
-                expr->addTerm(y_variables.getElement(ij, kl), 1.0);
+                lp_->addTerm(yVar(ij, kl), 1.0);
             }
-            std::string id = "edge_" + std::to_string(ij);
-            auto* c = new LinearConstraint(id, expr, LinearConstraint::EQUAL, 1.0);
-            lp_->addConstraint(c);
+            double copies = pb_->getQuery()->getMultiplicity(ij);
+            lp_->addConstraint(ConstraintStore::EQUAL, copies);
         }
 
-        // Constraint 4 (F2): Edge consistency constraints
+        // Constraint 4 (F2): Edge consistency constraints, from the incidence lists of k
+        const Graph* t = pb_->getTarget();
         for (int ij = 0; ij < nEP; ++ij) {
-            int i = pb_->getQuery()->getEdge(ij)->getOrigin()->getIndex();
-            int j = pb_->getQuery()->getEdge(ij)->getTarget()->getIndex();
+            int i = pb_->getQuery()->getOrigin(ij);
+            int j = pb_->getQuery()->getTarget(ij);
+            double copies = pb_->getQuery()->getMultiplicity(ij);
 
             for (int k = 0; k < nVT; ++k) {
-                LinearExpression* e1 = new LinearExpression();
-                LinearExpression* e2 = new LinearExpression();
-
-                // Sum over edges incident to vertex k
-                for (int kl = 0; kl < nET; ++kl) {
-                    Edge* target_edge = pb_->getTarget()->getEdge(kl);
-                    int k_out = target_edge->getOrigin()->getIndex();
-                    int k_in = target_edge->getTarget()->getIndex();
-
-                    if (k_out == k) {
-                        e1->addTerm(y_variables.getElement(ij, kl), 1.0);
+                if (!pb_->getQuery()->isDirected()) {
+                    // Undirected: edges incident to k need i or j mapped to k (a self-loop
+                    // {k,k} is both an in- and an out-edge, so only the out-edge is taken)
+                    lp_->addTerm(xVar(i, k), -copies);
+                    if (j != i) {
+                        lp_->addTerm(xVar(j, k), -copies);
                     }
-                    if (k_in == k) {
-                        e2->addTerm(y_variables.getElement(ij, kl), 1.0);
+                    for (int kl : t->getInEdges(k)) {
+                        if (t->getOrigin(kl) != k) lp_->addTerm(yVar(ij, kl), 1.0);
                     }
+                    for (int kl : t->getOutEdges(k)) lp_->addTerm(yVar(ij, kl), 1.0);
+                    lp_->addConstraint(ConstraintStore::LESS_EQ, 0.0);
+                    continue;
                 }
 
-                e1->addTerm(x_variables.getElement(i, k), -1.0);
-                e2->addTerm(x_variables.getElement(j, k), -1.0);
-
-                std::string id1 = "edge_cons_" + std::to_string(ij) + "_" + std::to_string(k) + "_out";
-                std::string id2 = "edge_cons_" + std::to_string(ij) + "_" + std::to_string(k) + "_in";
+                // Out-row: sum of y_ij,kl over edges kl leaving k <= copies * x_ik
+                lp_->addTerm(xVar(i, k), -copies);
+                for (int kl : t->getOutEdges(k)) lp_->addTerm(yVar(ij, kl), 1.0);
+                lp_->addConstraint(ConstraintStore::LESS_EQ, 0.0);
 
-                auto* c1 = new LinearConstraint(id1, e1, LinearConstraint::LESS_EQ, 0.0);
-                auto* c2 = new LinearConstraint(id2, e2, LinearConstraint::LESS_EQ, 0.0);
-
-                lp_->addConstraint(c1);
-                lp_->addConstraint(c2);
+                // In-row: sum of y_ij,kl over edges kl entering k <= copies * x_jk
+                lp_->addTerm(xVar(j, k), -copies);
+                for (int kl : t->getInEdges(k)) lp_->addTerm(yVar(ij, kl), 1.0);
+                lp_->addConstraint(ConstraintStore::LESS_EQ, 0.0);
             }
         }
 
         // Constraint 5: Induced subgraph constraints (if required)
         if (induced_) {
             for (int kl = 0; kl < nET; ++kl) {
-                int k = pb_->getTarget()->getEdge(kl)->getOrigin()->getIndex();
-                int l = pb_->getTarget()->getEdge(kl)->getTarget()->getIndex();
-
-                LinearExpression* expr = new LinearExpression();
+                int k = pb_->getTarget()->getOrigin(kl);
+                int l = pb_->getTarget()->getTarget(kl);
 
                 // Sum all pattern vertices mapped to k
                 for (int i = 0; i < nVP; ++i) {
-                    expr->addTerm(x_variables.getElement(i, k), 1.0);
+                    lp_->addTerm(xVar(i, k), 1.0);
                 }
 
                 // Sum all pattern vertices mapped to l
                 for (int i = 0; i < nVP; ++i) {
-                    expr->addTerm(x_variables.getElement(i, l), 1.0);
+                    lp_->addTerm(xVar(i, l), 1.0);
                 }
 
                 // Subtract edge mappings
                 for (int ij = 0; ij < nEP; ++ij) {
-                    expr->addTerm(y_variables.getElement(ij, kl), -1.0);
+                    lp_->addTerm(yVar(ij, kl), -1.0);
                 }
 
-                std::string id = "induced_" + std::to_string(kl);
-                auto* c = new LinearConstraint(id, expr, LinearConstraint::LESS_EQ, 1.0);
-                lp_->addConstraint(c);
+                lp_->addConstraint(ConstraintStore::LESS_EQ, 1.0);
             }
         }
     }
@@ -249,21 +237,23 @@ private:
         LinearExpression* obj = new LinearExpression();
 
         // Add vertex substitution costs
+        const CostTable& vertexCosts = pb_->getCostTable(true);
         for (int i = 0; i < nVP; ++i) {
             for (int k = 0; k < nVT; ++k) {
-                double cost = x_costs.getElement(i, k);
+                double cost = vertexCosts.get(i, k);
                 if (cost > 0) {
-                    obj->addTerm(x_variables.getElement(i, k), cost);
+                    obj->addTerm(xVar(i, k), cost);
                 }
             }
         }
 
         // Add edge substitution costs
+        const CostTable& edgeCosts = pb_->getCostTable(false);
         for (int ij = 0; ij < nEP; ++ij) {
             for (int kl = 0; kl < nET; ++kl) {
-                double cost = y_costs.getElement(ij, kl);
+                double cost = edgeCosts.get(ij, kl);
                 if (cost > 0) {
-                    obj->addTerm(y_variables.getElement(ij, kl), cost);
+                    obj->addTerm(yVar(ij, kl), cost);
                 }
             }
         }
@@ -280,11 +270,8 @@ private:
     // Problem dimensions
     int nVP, nVT, nEP, nET;
 
-    // Variable and cost matrices
-    Matrix<Variable*> x_variables;
-    Matrix<Variable*> y_variables;
-    Matrix<double> x_costs;
-    Matrix<double> y_costs;
+    // Column layout of the x and y variables
+    MatchingLayout layout_;
 };
 
 } // namespace gempp
@@ -2,41 +2,66 @@
 #define V2_LINEAR_PROGRAM_H
 
 #include "variable.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
 #include <vector>
-#include <unordered_map>
-#include <memory>
 
 namespace gempp {
 
-// Linear Expression: sum of (coefficient * variable) + constant
+// Linear Expression: sum of (coefficient * column) + constant, as a flat list of terms.
+// Terms are appended as given; compact() sorts them by column and merges duplicates.
 class LinearExpression {
 public:
     LinearExpression() : constant_(0.0) {}
 
-    void addTerm(Variable* var, double coeff) {
-        if (var) {
-            terms_[var] += coeff;
-        }
-    }
+    void addTerm(int col, double coeff) { terms_.push_back({col, coeff}); }
 
     void setConstant(double c) { constant_ = c; }
     double getConst() const { return constant_; }
 
-    const std::unordered_map<Variable*, double>& getTerms() const {
-        return terms_;
-    }
+    const std::vector<std::pair<int, double>>& getTerms() const { return terms_; }
 
-    std::unordered_map<Variable*, double>& getTerms() {
-        return terms_;
+    void compact() {
+        std::sort(terms_.begin(), terms_.end(),
+                  [](const std::pair<int, double>& a, const std::pair<int, double>& b) {
+                      return a.first < b.first;
+                  });
+        size_t out = 0;
+        for (size_t t = 0; t < terms_.size(); ++t) {
+            if (out > 0 && terms_[out - 1].first == terms_[t].first) {
+                terms_[out - 1].second += terms_[t].second;
+            } else {
+                terms_[out++] = terms_[t];
+            }
+        }
+        terms_.resize(out);
     }
 
 private:
-    std::unordered_map<Variable*, double> terms_;
+    std::vector<std::pair<int, double>> terms_;
     double constant_;
 };
 
-// Linear Constraint
-class LinearConstraint {
+class RowSink;
+
+// Constraint rows of a LinearProgram in compressed sparse row (CSR) form.
+//
+// Terms of the row under construction are appended with addTerm(); addRow() closes the
+// row with its relation and right-hand side. All rows share three contiguous arrays (row
+// offsets, columns, coefficients), so a row costs no allocation and carries no name.
+// Within a row, columns are sorted and duplicate columns merged.
+//
+// Closing a row also compacts it against the variables: terms on inactive (fixed-to-zero)
+// columns are dropped, and a row left empty is discarded when zero satisfies it (an
+// unsatisfiable empty row is kept so that the model stays infeasible). Discarded rows get
+// no index and are only counted (getRemovedRowCount()).
+//
+// Rows closed with streamRow() are handed to a RowSink and not kept: they count in size()
+// and getNonZeroCount(), but the row accessors only cover the kept rows
+// (0..getStoredRowCount()-1).
+class ConstraintStore {
 public:
     enum Relation {
         LESS_EQ,
@@ -44,26 +69,158 @@ public:
         EQUAL
     };
 
-    LinearConstraint(const std::string& id, LinearExpression* expr, Relation rel, double rhs)
-        : id_(id), expr_(expr), relation_(rel), rhs_(rhs)
-    {}
+    ConstraintStore()
+        : row_start_(1, 0), streamed_rows_(0), streamed_nonzeros_(0), removed_rows_(0),
+          removed_nonzeros_(0) {}
 
-    ~LinearConstraint() {
-        delete expr_;
+    int size() const { return getStoredRowCount() + streamed_rows_; }
+    int getNonZeroCount() const { return static_cast<int>(cols_.size()) + streamed_nonzeros_; }
+    int getStoredRowCount() const { return static_cast<int>(rhs_.size()); }
+
+    // Rows discarded and terms dropped by compaction
+    int getRemovedRowCount() const { return removed_rows_; }
+    int getRemovedNonZeroCount() const { return removed_nonzeros_; }
+
+    void reserve(int rows, int nonZeros) {
+        row_start_.reserve(rows + 1);
+        relation_.reserve(rows);
+        rhs_.reserve(rows);
+        cols_.reserve(nonZeros);
+        coefs_.reserve(nonZeros);
     }
 
-    const std::string& getID() const { return id_; }
-    LinearExpression* getLinearExpression() const { return expr_; }
-    Relation getRelation() const { return relation_; }
-    double getRHS() const { return rhs_; }
+    // Appends a term to the row under construction
+    void addTerm(int col, double coeff) {
+        cols_.push_back(col);
+        coefs_.push_back(coeff);
+    }
+
+    // Closes the row under construction: sum(terms) <relation> rhs. Terms on columns that
+    // are inactive in vars (if given) are dropped. Returns its index, or -1 if discarded.
+    int addRow(Relation relation, double rhs, const VariableStore* vars = nullptr) {
+        if (!compactOpenRow(vars, relation, rhs)) return -1;
+        row_start_.push_back(static_cast<int>(cols_.size()));
+        relation_.push_back(static_cast<uint8_t>(relation));
+        rhs_.push_back(rhs);
+        return size() - 1;
+    }
+
+    // Closes the row under construction, compacted against vars, and hands it to sink
+    // instead of keeping it. Returns its index, or -1 if discarded.
+    inline int streamRow(RowSink& sink, const VariableStore& vars, Relation relation,
+                         double rhs);
+
+    int getRowSize(int r) const { return row_start_[r + 1] - row_start_[r]; }
+    const int* getColumns(int r) const { return cols_.data() + row_start_[r]; }
+    const double* getCoefficients(int r) const { return coefs_.data() + row_start_[r]; }
+    Relation getRelation(int r) const { return static_cast<Relation>(relation_[r]); }
+    double getRHS(int r) const { return rhs_[r]; }
+
+    // Bytes held by the row arrays
+    size_t getMemoryUsage() const {
+        return row_start_.capacity() * sizeof(int) + cols_.capacity() * sizeof(int) +
+               coefs_.capacity() * sizeof(double) + relation_.capacity() +
+               rhs_.capacity() * sizeof(double);
+    }
 
 private:
-    std::string id_;
-    LinearExpression* expr_;
-    Relation relation_;
-    double rhs_;
+    // Sorts the open row by column, merges duplicate columns and drops zero coefficients and
+    // inactive columns. Returns false (and clears the row) if the row is to be discarded.
+    bool compactOpenRow(const VariableStore* vars, Relation relation, double rhs) {
+        size_t begin = static_cast<size_t>(row_start_.back());
+        size_t end = cols_.size();
+        bool sorted = true;
+        for (size_t t = begin + 1; t < end && sorted; ++t) {
+            sorted = cols_[t - 1] < cols_[t];
+        }
+        if (!sorted) {
+            scratch_.clear();
+            for (size_t t = begin; t < end; ++t) scratch_.push_back({cols_[t], coefs_[t]});
+            std::sort(scratch_.begin(), scratch_.end(),
+                      [](const std::pair<int, double>& a, const std::pair<int, double>& b) {
+                          return a.first < b.first;
+                      });
+            end = begin;
+            for (const auto& term : scratch_) {
+                if (end > begin && cols_[end - 1] == term.first) {
+                    coefs_[end - 1] += term.second;
+                } else {
+                    cols_[end] = term.first;
+                    coefs_[end] = term.second;
+                    ++end;
+                }
+            }
+        }
+
+        size_t kept = begin;
+        for (size_t t = begin; t < end; ++t) {
+            if (coefs_[t] == 0.0) continue;
+            if (vars && !vars->isActive(cols_[t])) {
+                ++removed_nonzeros_;
+                continue;
+            }
+            cols_[kept] = cols_[t];
+            coefs_[kept] = coefs_[t];
+            ++kept;
+        }
+        cols_.resize(kept);
+        coefs_.resize(kept);
+
+        if (kept == begin && satisfiedByZero(relation, rhs)) {
+            ++removed_rows_;
+            return false;
+        }
+        return true;
+    }
+
+    static bool satisfiedByZero(Relation relation, double rhs) {
+        switch (relation) {
+            case LESS_EQ:
+                return rhs >= 0.0;
+            case GREATER_EQ:
+                return rhs <= 0.0;
+            case EQUAL:
+                return rhs == 0.0;
+        }
+        return false;
+    }
+
+    std::vector<int> row_start_;     // rows + 1 offsets into cols_/coefs_
+    std::vector<int> cols_;
+    std::vector<double> coefs_;
+    std::vector<uint8_t> relation_;  // per row
+    std::vector<double> rhs_;        // per row
+    std::vector<std::pair<int, double>> scratch_;
+    int streamed_rows_;
+    int streamed_nonzeros_;
+    int removed_rows_;
+    int removed_nonzeros_;
+};
+
+// Receives constraint rows as they are closed (see LinearProgram::setRowSink), so that a
+// solver can build its own copy of the matrix without the LinearProgram keeping one.
+class RowSink {
+public:
+    virtual ~RowSink() {}
+
+    // Row over the columns of vars: size terms on active columns, sorted, without zeros
+    virtual void addRow(const VariableStore& vars, const int* cols, const double* coefs,
+                        int size, ConstraintStore::Relation relation, double rhs) = 0;
 };
 
+inline int ConstraintStore::streamRow(RowSink& sink, const VariableStore& vars,
+                                      Relation relation, double rhs) {
+    if (!compactOpenRow(&vars, relation, rhs)) return -1;
+    size_t begin = static_cast<size_t>(row_start_.back());
+    int rowSize = static_cast<int>(cols_.size() - begin);
+    sink.addRow(vars, cols_.data() + begin, coefs_.data() + begin, rowSize, relation, rhs);
+    cols_.resize(begin);
+    coefs_.resize(begin);
+    ++streamed_rows_;
+    streamed_nonzeros_ += rowSize;
+    return size() - 1;
+}
+
 // Linear Program
 class LinearProgram {
 public:
@@ -72,15 +229,10 @@ public:
         MAXIMIZE
     };
 
-    explicit LinearProgram(Sense sense) : sense_(sense), objective_(new LinearExpression()) {}
+    explicit LinearProgram(Sense sense)
+        : sense_(sense), objective_(new LinearExpression()), sink_(nullptr) {}
 
     ~LinearProgram() {
-        for (auto& pair : variables_) {
-            delete pair.second;
-        }
-        for (auto* constraint : constraints_) {
-            delete constraint;
-        }
         delete objective_;
     }
 
@@ -91,51 +243,55 @@ public:
     Sense getSense() const { return sense_; }
     void setSense(Sense sense) { sense_ = sense; }
 
-    void addVariable(Variable* v) {
-        if (v && variables_.find(v->getID()) == variables_.end()) {
-            variables_[v->getID()] = v;
-        }
+    // Adds a variable and returns its column index
+    int addVariable(VariableStore::Type type = VariableStore::BINARY, int lowerBound = 0,
+                    int upperBound = 1) {
+        return variables_.add(type, lowerBound, upperBound);
     }
 
-    Variable* getVariable(const std::string& id) const {
-        auto it = variables_.find(id);
-        return (it != variables_.end()) ? it->second : nullptr;
-    }
+    int getVariableCount() const { return variables_.size(); }
 
-    const std::unordered_map<std::string, Variable*>& getVariables() const {
-        return variables_;
-    }
+    const VariableStore& getVariables() const { return variables_; }
+    VariableStore& getVariables() { return variables_; }
+
+    // Appends a term to the constraint under construction
+    void addTerm(int col, double coeff) { constraints_.addTerm(col, coeff); }
 
-    std::unordered_map<std::string, Variable*>& getVariables() {
-        return variables_;
+    // Closes the constraint under construction, dropping terms on inactive variables;
+    // returns its row index, or -1 if it was left empty and discarded
+    int addConstraint(ConstraintStore::Relation relation, double rhs) {
+        if (sink_) return constraints_.streamRow(*sink_, variables_, relation, rhs);
+        return constraints_.addRow(relation, rhs, &variables_);
     }
 
-    void addConstraint(LinearConstraint* c) {
-        if (c) {
-            constraints_.push_back(c);
+    // Hands every constraint to sink as it is closed instead of storing it (nullptr: store).
+    // Must be set before the first constraint.
+    void setRowSink(RowSink* sink) {
+        if (getConstraintCount() > 0) {
+            throw Exception("Row sink must be set before adding constraints");
         }
+        sink_ = sink;
     }
 
-    const std::vector<LinearConstraint*>& getConstraints() const {
-        return constraints_;
-    }
+    int getConstraintCount() const { return constraints_.size(); }
 
-    std::vector<LinearConstraint*>& getConstraints() {
-        return constraints_;
-    }
+    const ConstraintStore& getConstraints() const { return constraints_; }
+    ConstraintStore& getConstraints() { return constraints_; }
 
     LinearExpression* getObjective() const { return objective_; }
 
     void setObjective(LinearExpression* obj) {
         delete objective_;
         objective_ = obj;
+        objective_->compact();
     }
 
 private:
     Sense sense_;
-    std::unordered_map<std::string, Variable*> variables_;
-    std::vector<LinearConstraint*> constraints_;
+    VariableStore variables_;
+    ConstraintStore constraints_;
     LinearExpression* objective_;
+    RowSink* sink_;
 };
 
 } // namespace gempp
@@ -2,23 +2,21 @@
 #define V2_VARIABLE_H
 
 #include "../core/types.h"
+#include <cstdint>
+#include <functional>
+#include <string>
 #include <utility>
-#include <unordered_map>
+#include <vector>
 
 namespace gempp {
 
-class Variable;
-
-// Term represents multiplication of a variable by a coefficient
-using Term = std::pair<Variable*, double>;
-
-// Quad represents multiplication of two variables
-using Quad = std::pair<Variable*, Variable*>;
-
-// QuadTerm represents multiplication of a Quad by a coefficient
-using QuadTerm = std::pair<Quad, double>;
-
-class Variable {
+// Variables of a LinearProgram, stored column-wise (struct of arrays).
+//
+// A variable is a dense column index 0..size()-1; its kind and bounds live in parallel
+// arrays, so a model with millions of columns costs a few bytes per column and no strings.
+// Names are only produced on demand (getName), from a naming function installed by the
+// formulation, for debugging and model export.
+class VariableStore {
 public:
     enum Type {
         BOUNDED,    // bounded integer variable
@@ -26,86 +24,73 @@ public:
         CONTINUOUS  // continuous variable
     };
 
-    Variable(const std::string& id, Type type = BINARY, int lowerBound = 0, int upperBound = 1)
-        : id_(id), type_(type), lowerBound_(lowerBound), upperBound_(upperBound), value_(0)
-    {
-        if (type == BINARY) {
-            lowerBound_ = 0;
-            upperBound_ = 1;
-        }
-    }
-
-    const std::string& getID() const { return id_; }
-    void setID(const std::string& id) { id_ = id; }
-
-    Type getType() const { return type_; }
-    void setType(Type type) { type_ = type; }
+    using Namer = std::function<std::string(int)>;
 
-    int getLowerBound() const { return lowerBound_; }
-    void setLowerBound(int low) { lowerBound_ = low; }
+    int size() const { return static_cast<int>(type_.size()); }
 
-    int getUpperBound() const { return upperBound_; }
-    void setUpperBound(int up) { upperBound_ = up; }
+    void reserve(int count) {
+        type_.reserve(count);
+        lower_.reserve(count);
+        upper_.reserve(count);
+    }
 
-    void activate(int low = 0, int up = 1) {
-        if (type_ == BINARY) {
-            lowerBound_ = 0;
-            upperBound_ = 1;
-        } else {
-            lowerBound_ = low;
-            upperBound_ = up;
+    // Adds a variable and returns its column index
+    int add(Type type = BINARY, int lowerBound = 0, int upperBound = 1) {
+        if (type == BINARY) {
+            lowerBound = 0;
+            upperBound = 1;
         }
+        type_.push_back(static_cast<uint8_t>(type));
+        lower_.push_back(lowerBound);
+        upper_.push_back(upperBound);
+        return size() - 1;
     }
 
-    void deactivate() {
-        lowerBound_ = 0;
-        upperBound_ = 0;
-    }
+    Type getType(int col) const { return static_cast<Type>(type_[col]); }
+    int getLowerBound(int col) const { return lower_[col]; }
+    int getUpperBound(int col) const { return upper_[col]; }
 
-    bool isActive() const {
-        return !(lowerBound_ == 0 && upperBound_ == 0);
+    void activate(int col, int low = 0, int up = 1) {
+        if (getType(col) == BINARY) {
+            lower_[col] = 0;
+            upper_[col] = 1;
+        } else {
+            lower_[col] = low;
+            upper_[col] = up;
+        }
     }
 
-    void addColumn(const std::string& id, double d) {
-        columns_[id] = d;
+    void deactivate(int col) {
+        lower_[col] = 0;
+        upper_[col] = 0;
     }
 
-    std::unordered_map<std::string, double>& getColumns() {
-        return columns_;
+    bool isActive(int col) const {
+        return !(lower_[col] == 0 && upper_[col] == 0);
     }
 
-    double getColumn(const std::string& id) const {
-        auto it = columns_.find(id);
-        return (it != columns_.end()) ? it->second : 0.0;
+    int getActiveCount() const {
+        int count = 0;
+        for (int col = 0; col < size(); ++col) {
+            if (isActive(col)) ++count;
+        }
+        return count;
     }
 
-    void setValue(int val) { value_ = val; }
-    int eval() const { return value_; }
+    void setNamer(Namer namer) { namer_ = std::move(namer); }
 
-    // Conversion operator to Term
-    operator Term() const {
-        return std::make_pair(const_cast<Variable*>(this), 1.0);
+    // Debug name of a column ("c<col>" without a naming function)
+    std::string getName(int col) const {
+        return namer_ ? namer_(col) : "c" + std::to_string(col);
     }
 
 private:
-    std::string id_;
-    Type type_;
-    int lowerBound_;
-    int upperBound_;
-    int value_;
-    std::unordered_map<std::string, double> columns_;
+    std::vector<uint8_t> type_;
+    std::vector<int> lower_;
+    std::vector<int> upper_;
+    Namer namer_;
 };
 
-// Helper functions
-inline bool operator==(const Quad& q1, const Quad& q2) {
-    return (q1.first == q2.first && q1.second == q2.second) ||
-           (q1.first == q2.second && q1.second == q2.first);
-}
-
-inline bool isActive(const QuadTerm& t) {
-    return t.first.first->isActive() && t.first.second->isActive();
-}
-
 } // namespace gempp
 
 #endif // V2_VARIABLE_H
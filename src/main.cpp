@@ -1,10 +1,19 @@
 #include "model/adjacency_parser.h"
 #include "model/problem.h"
+#include "formulation/edge_consistency.h"
 #include "formulation/mcsm.h"
 #include "formulation/linear_ged.h"
+#include "solver/bipartite_ged.h"
+#include "solver/bit_solver.h"
 #include "solver/glpk_solver.h"
 #include "solver/greedy_solver.h"
+#include "solver/lp_rounding.h"
+#include "solver/mcs_solver.h"
+#include "solver/matching.h"
+#include "solver/model_cache.h"
+#include "solver/subgraph_matcher.h"
 #include "visualization/graph_canvas.h"
+#include "core/resource_usage.h"
 #include <iostream>
 #include <iomanip>
 #include <fstream>
@@ -15,13 +24,32 @@
 #include <chrono>
 #include <string>
 #include <set>
+#include <memory>
+#include <climits>
+#include <csignal>
 
 using namespace gempp;
 
+// XML status of a matching ("optimal" also for the optimum of a relaxation)
+static const char* statusName(Matching::Status status) {
+    switch (status) {
+        case Matching::OPTIMAL:
+            return "optimal";
+        case Matching::FEASIBLE:
+            return "feasible";
+        case Matching::INFEASIBLE:
+            return "infeasible";
+        case Matching::UNBOUNDED:
+            return "unbounded";
+        case Matching::NOT_SOLVED:
+            break;
+    }
+    return "not_solved";
+}
+
 static void writeSolutionXML(const std::string& filename,
                              Problem* problem,
-                             const std::unordered_map<std::string, double>& solution,
-                             double objective,
+                             const Matching& matching,
                              bool is_ged)
 {
     std::ofstream out(filename);
@@ -32,40 +60,20 @@ static void writeSolutionXML(const std::string& filename,
 
     int nVP = problem->getQuery()->getVertexCount();
     int nVT = problem->getTarget()->getVertexCount();
-    int nEP = problem->getQuery()->getEdgeCount();
-    int nET = problem->getTarget()->getEdgeCount();
-
-    std::vector<int> matched_pattern_vertices(nVP, -1);
-    std::vector<int> matched_target_vertices(nVT, -1);
-    std::vector<int> matched_pattern_edges(nEP, -1);
-    std::vector<int> matched_target_edges(nET, -1);
-
-    auto is_active = [](double v) { return v >= 0.5; };
-
-    for (const auto& kv : solution) {
-        if (!is_active(kv.second)) continue;
-        const std::string& id = kv.first;
-        if (id.rfind("x_", 0) == 0) {
-            auto comma = id.find(',');
-            int i = std::stoi(id.substr(2, comma - 2));
-            int k = std::stoi(id.substr(comma + 1));
-            matched_pattern_vertices[i] = k;
-            matched_target_vertices[k] = i;
-        } else if (id.rfind("y_", 0) == 0) {
-            auto comma = id.find(',');
-            int ij = std::stoi(id.substr(2, comma - 2));
-            int kl = std::stoi(id.substr(comma + 1));
-            matched_pattern_edges[ij] = kl;
-            matched_target_edges[kl] = ij;
-        }
-    }
+    double objective = matching.getObjective();
+    const std::vector<int>& matched_pattern_vertices = matching.getTargetVertices();
+    const std::vector<int>& matched_target_vertices = matching.getPatternVertices();
 
     auto safeCost = [](double v) { return std::isfinite(v) ? v : 0.0; };
 
     out << "<?xml version=\"1.0\"?>\n";
     out << "<solution>\n";
-    out << "  <objective status=\"" << (std::isinf(objective) ? "infeasible" : "optimal")
-        << "\" value=\"" << (std::isinf(objective) ? "inf" : std::to_string(objective)) << "\"/>\n";
+    out << "  <objective status=\"" << statusName(matching.getStatus())
+        << "\" value=\"" << (std::isinf(objective) ? "inf" : std::to_string(objective)) << "\"";
+    if (matching.getStatus() != Matching::OPTIMAL && std::isfinite(matching.getBound())) {
+        out << " bound=\"" << std::to_string(matching.getBound()) << "\"";
+    }
+    out << "/>\n";
 
     // Nodes section
     out << "  <nodes>\n";
@@ -97,55 +105,247 @@ static void writeSolutionXML(const std::string& filename,
     }
     out << "  </nodes>\n";
 
-    // Edges section
+    // Edges section (one element per parallel copy and arc; an undirected edge is two arcs)
+    const Graph* qg = problem->getQuery();
+    const Graph* tg = problem->getTarget();
+    auto writeEdge = [&](const char* type, int from, int to) {
+        out << "      <edge type=\"" << type << "\" from=\"" << from << "\" to=\"" << to << "\"/>\n";
+    };
     out << "  <edges>\n";
-    for (int ij = 0; ij < nEP; ++ij) {
-        int kl = matched_pattern_edges[ij];
-        if (kl >= 0) {
-            double cost = safeCost(problem->getCost(false, ij, kl));
-            Edge* qe = problem->getQuery()->getEdge(ij);
-            Edge* te = problem->getTarget()->getEdge(kl);
-            out << "    <substitution cost=\"" << cost << "\">\n";
-            out << "      <edge type=\"query\" from=\"" << qe->getOrigin()->getIndex()
-                << "\" to=\"" << qe->getTarget()->getIndex() << "\"/>\n";
-            out << "      <edge type=\"target\" from=\"" << te->getOrigin()->getIndex()
-                << "\" to=\"" << te->getTarget()->getIndex() << "\"/>\n";
-            out << "    </substitution>\n";
+    for (const Matching::EdgeMatch& sub : matching.getEdgeMatches()) {
+        int ij = sub.pattern;
+        int kl = sub.target;
+        double cost = safeCost(problem->getCost(false, ij, kl));
+        std::vector<std::pair<int, int>> query_arcs, target_arcs;
+        appendArcs(qg, ij, query_arcs);
+        appendArcs(tg, kl, target_arcs);
+        // Orient the target arcs like the query arcs under the vertex matching
+        if (target_arcs.size() == 2 && matched_pattern_vertices[qg->getOrigin(ij)] == tg->getTarget(kl)) {
+            std::swap(target_arcs[0], target_arcs[1]);
         }
-    }
-    for (int ij = 0; ij < nEP; ++ij) {
-        if (matched_pattern_edges[ij] < 0) {
-            Edge* qe = problem->getQuery()->getEdge(ij);
-            out << "    <insertion cost=\"1\">\n";
-            out << "      <edge type=\"query\" from=\"" << qe->getOrigin()->getIndex()
-                << "\" to=\"" << qe->getTarget()->getIndex() << "\"/>\n";
-            out << "    </insertion>\n";
+        for (int c = 0; c < sub.copies; ++c) {
+            for (size_t a = 0; a < query_arcs.size() && a < target_arcs.size(); ++a) {
+                out << "    <substitution cost=\"" << cost << "\">\n";
+                writeEdge("query", query_arcs[a].first, query_arcs[a].second);
+                writeEdge("target", target_arcs[a].first, target_arcs[a].second);
+                out << "    </substitution>\n";
+            }
         }
     }
+    for (const auto& arc : matching.getUnmatchedPatternArcs()) {
+        out << "    <insertion cost=\"1\">\n";
+        writeEdge("query", arc.first, arc.second);
+        out << "    </insertion>\n";
+    }
     if (is_ged) {
-        for (int kl = 0; kl < nET; ++kl) {
-            if (matched_target_edges[kl] < 0) {
-                Edge* te = problem->getTarget()->getEdge(kl);
-                out << "    <deletion cost=\"1\">\n";
-                out << "      <edge type=\"target\" from=\"" << te->getOrigin()->getIndex()
-                    << "\" to=\"" << te->getTarget()->getIndex() << "\"/>\n";
-                out << "    </deletion>\n";
-            }
+        for (const auto& arc : matching.getUnmatchedTargetArcs()) {
+            out << "    <deletion cost=\"1\">\n";
+            writeEdge("target", arc.first, arc.second);
+            out << "    </deletion>\n";
         }
     }
     out << "  </edges>\n";
     out << "</solution>\n";
 }
 
+static double elapsedMs(std::chrono::high_resolution_clock::time_point from,
+                        std::chrono::high_resolution_clock::time_point to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+// --stats report: phase times, model size (if an LP was built or loaded) and peak memory
+static void printStats(double parse_ms, double build_ms, double solve_ms, const LinearProgram* lp,
+                       const GLPKSolver* solver = nullptr, const MCSSolver* search = nullptr) {
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Parse: " << parse_ms << " ms, Build: " << build_ms << " ms, Solve: "
+              << solve_ms << " ms" << std::endl;
+    if (lp) {
+        // Size of the compacted model handed to the solver, then what compaction removed
+        const ConstraintStore& constraints = lp->getConstraints();
+        int columns = lp->getVariables().getActiveCount();
+        std::cout << "Model: " << lp->getConstraintCount() << " rows, " << columns << " columns, "
+                  << constraints.getNonZeroCount() << " nonzeros" << std::endl;
+        std::cout << "Removed: " << constraints.getRemovedRowCount() << " rows, "
+                  << lp->getVariableCount() - columns << " fixed-zero columns, "
+                  << constraints.getRemovedNonZeroCount() << " nonzeros" << std::endl;
+    } else if (solver) {
+        // Model read from the cache: only GLPK knows its size
+        std::cout << "Model: " << solver->getRowCount() << " rows, " << solver->getColumnCount()
+                  << " columns, " << solver->getNonZeroCount() << " nonzeros (cached)" << std::endl;
+    }
+    if (solver && solver->getNodeCount() > 0) {
+        std::cout << "Branch-and-bound nodes: " << solver->getNodeCount() << std::endl;
+    }
+    if (solver && solver->getFirstIncumbentTime() >= 0.0) {
+        std::cout << "First incumbent: " << solver->getFirstIncumbentTime() << " ms" << std::endl;
+    }
+    if (solver && solver->getRoundingCount() > 0) {
+        std::cout << "LP rounding: " << solver->getRoundingImprovements() << " incumbents from "
+                  << solver->getRoundingCount() << " nodes" << std::endl;
+    }
+    if (solver && solver->getLazyRowCount() > 0) {
+        std::cout << "Lazy rows: " << solver->getLazyRowCount() << " added in "
+                  << solver->getLazyRounds() << " rounds" << std::endl;
+    }
+    if (search) {
+        std::cout << "Search nodes: " << search->getNodeCount() << std::endl;
+        if (search->getPeakOpenNodes() > 0) {
+            std::cout << "Open nodes (peak): " << search->getPeakOpenNodes()
+                      << (search->isMemoryLimited() ? " (memory limit reached, then depth-first)" : "")
+                      << std::endl;
+        }
+        if (search->getFirstIncumbentTime() >= 0.0) {
+            std::cout << "First incumbent: " << search->getFirstIncumbentTime() << " ms" << std::endl;
+        }
+        if (std::isfinite(search->getLowerBound())) {
+            std::cout << "Lower bound: " << search->getLowerBound()
+                      << (search->isBoundMet() ? " (reached, search stopped)" : "") << std::endl;
+        }
+    }
+    if (solver && std::isfinite(solver->getLowerBound())) {
+        std::cout << "Lower bound: " << solver->getLowerBound()
+                  << (solver->isBoundMet() ? " (reached, search stopped)" : "") << std::endl;
+    }
+    std::cout << "Peak RSS: " << peakResidentBytes() / (1024.0 * 1024.0) << " MB" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+}
+
+// Set by SIGINT while a solver searches: the solver stops and the best solution so far is
+// printed
+static volatile std::sig_atomic_t g_interrupted = 0;
+
+// Restores the default action, so that a second interrupt ends the process even if the
+// solver does not get to check the flag
+static void onInterrupt(int) {
+    g_interrupted = 1;
+    std::signal(SIGINT, SIG_DFL);
+}
+
+// Search budgets from the command line
+struct SolveLimits {
+    double time_limit = 0.0;  // seconds, 0: none
+    int node_limit = 0;       // 0: none
+    double gap = 1e-9;        // relative gap target
+};
+
+template <class Solver>
+static void applyLimits(Solver& solver, const SolveLimits& limits) {
+    solver.setTimeLimit(limits.time_limit);
+    solver.setNodeLimit(limits.node_limit);
+    solver.setMipGap(limits.gap);
+    solver.setStopFlag(&g_interrupted);
+}
+
+// Solves with SIGINT caught: the first interrupt stops the search, a second one the process
+static Matching solveInterruptible(GLPKSolver& solver, const Problem* problem) {
+    std::signal(SIGINT, onInterrupt);
+    Matching matching = solver.solve(problem);
+    std::signal(SIGINT, SIG_DFL);
+    return matching;
+}
+
+// Native search (--mcs) with the lower bounds of the formulation and the greedy warm start
+static void configureSearch(MCSSolver& search, Problem* problem, const LowerBounds& bounds,
+                            bool warm_start, bool best_first, double memory_limit_mb)
+{
+    search.setLowerBound(bounds.get());
+    if (warm_start) {
+        GreedySolver greedy(problem);
+        search.setWarmStart(greedy.solve().getTargetVertices());
+    }
+    search.setBestFirst(best_first);
+    search.setMemoryLimit(static_cast<size_t>(memory_limit_mb * 1024.0 * 1024.0));
+}
+
+static Matching solveInterruptible(MCSSolver& search) {
+    std::signal(SIGINT, onInterrupt);
+    Matching matching = search.solve();
+    std::signal(SIGINT, SIG_DFL);
+    return matching;
+}
+
+// Bit-parallel search over Bitset<Bits>, with the lower bound, warm start and budgets of the
+// exact modes; nodes receives its search node count
+template <int Bits>
+static Matching solveBitParallel(Problem* problem, double lower_bound, bool warm_start,
+                                 const SolveLimits& limits, long& nodes)
+{
+    BitParallelSolver<Bits> search(problem);
+    search.setLowerBound(lower_bound);
+    if (warm_start) {
+        GreedySolver greedy(problem);
+        search.setWarmStart(greedy.solve().getTargetVertices());
+    }
+    applyLimits(search, limits);
+    std::signal(SIGINT, onInterrupt);
+    Matching matching = search.solve();
+    std::signal(SIGINT, SIG_DFL);
+    nodes = search.getNodeCount();
+    return matching;
+}
+
+// Width of the bit-parallel solver that fits the problem (64 or 128), 0 if none does
+static int bitParallelWidth(const Problem* problem) {
+    if (BitParallelSolver<64>::fits(problem)) return 64;
+    if (BitParallelSolver<128>::fits(problem)) return 128;
+    return 0;
+}
+
+static Matching solveBitParallel(Problem* problem, int width, double lower_bound, bool warm_start,
+                                 const SolveLimits& limits, long& nodes)
+{
+    if (width == 64) return solveBitParallel<64>(problem, lower_bound, warm_start, limits, nodes);
+    return solveBitParallel<128>(problem, lower_bound, warm_start, limits, nodes);
+}
+
+// Cache file of the model for this input and settings ("" without a cache directory)
+static std::string modelCachePath(const std::string& cache_dir, const Graph* pattern,
+                                  const Graph* target, const std::string& settings)
+{
+    if (cache_dir.empty()) return "";
+    ModelCache cache(cache_dir);
+    cache.prepare();
+    return cache.path(ModelCache::key(pattern, target, settings));
+}
+
+// Loads the model of a MatchingLayout formulation from cache_file; false if absent
+static bool loadCachedModel(GLPKSolver& solver, const Problem* problem, const std::string& cache_file,
+                            bool relaxed, bool first_feasible)
+{
+    if (cache_file.empty()) return false;
+    MatchingLayout layout(problem);
+    return solver.readModel(cache_file, LinearProgram::MINIMIZE, layout.size(),
+                            [&layout](const std::string& name) { return layout.column(name); },
+                            false, relaxed, first_feasible);
+}
+
 int main(int argc, char* argv[]) {
     try {
         bool show_time = false;
+        bool show_stats = false;
         bool use_ged = false;
         bool use_f2lp = false;
         bool approx_minext = false;
         bool first_feasible = false;
+        bool keep_multiplicity = false;
+        bool force_directed = false;
+        bool warm_start = true;
+        bool lp_rounding = true;
+        bool lazy_edges = false;
+        bool use_mcs = false;
+        bool use_bipartite = false;
+        bool try_embedding = true;
+        bool use_bitset = true;
+        double embedding_time_limit = 1.0;
+        bool best_first = false;
+        double memory_limit_mb = 1024.0;
         double upper_bound = 1.0;
+        SolveLimits limits;
         std::string output_file;
+        std::string model_file;
+        std::string cache_dir;
         std::string input_file;
 
         // Parse arguments
@@ -153,6 +353,8 @@ int main(int argc, char* argv[]) {
             std::string arg = argv[i];
             if (arg == "--time" || arg == "-t") {
                 show_time = true;
+            } else if (arg == "--stats") {
+                show_stats = true;
             } else if (arg == "--ged" || arg == "-g") {
                 use_ged = true;
             } else if (arg == "--f2lp" || arg == "--lp") {
@@ -163,9 +365,41 @@ int main(int argc, char* argv[]) {
                 use_ged = true;
                 use_f2lp = true;
                 approx_minext = true;
+            } else if (arg == "--bipartite" || arg == "--bp") {
+                // GED bounds from one vertex assignment (Riesen-Bunke)
+                use_ged = true;
+                use_bipartite = true;
             } else if (arg == "--fast" || arg == "-f") {
                 // Stop at first feasible solution (not optimal)
                 first_feasible = true;
+            } else if (arg == "--multi" || arg == "-m") {
+                // One edge per vertex pair carrying its multiplicity
+                keep_multiplicity = true;
+            } else if (arg == "--no-warm-start") {
+                // Exact modes: start branch and bound without the greedy incumbent
+                warm_start = false;
+            } else if (arg == "--lazy") {
+                // F2 edge consistency rows added on demand instead of up front
+                lazy_edges = true;
+            } else if (arg == "--mcs") {
+                // Minimal extension by combinatorial branch and bound instead of the ILP
+                use_mcs = true;
+            } else if (arg == "--astar") {
+                // Native search, best-first
+                use_mcs = true;
+                best_first = true;
+            } else if (arg == "--no-bitset") {
+                // Exact modes: build the model even when the bit-parallel solver fits
+                use_bitset = false;
+            } else if (arg == "--no-iso") {
+                // Minimal extension: build the model without looking for an embedding first
+                try_embedding = false;
+            } else if (arg == "--no-rounding") {
+                // Exact modes: no LP rounding heuristic at the branch-and-bound nodes
+                lp_rounding = false;
+            } else if (arg == "--directed") {
+                // Keep symmetric inputs as directed graphs (two arcs per edge)
+                force_directed = true;
             } else if (arg == "--up" || arg == "-u") {
                 if (i + 1 >= argc) {
                     std::cerr << "Error: missing value after '" << arg << "'" << std::endl;
@@ -181,12 +415,47 @@ int main(int argc, char* argv[]) {
                     std::cerr << "Error: upper bound must be in (0,1]" << std::endl;
                     return 1;
                 }
+            } else if (arg == "--time-limit" || arg == "--node-limit" || arg == "--gap" ||
+                       arg == "--memory-limit" || arg == "--iso-time-limit") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: missing value after '" << arg << "'" << std::endl;
+                    return 1;
+                }
+                double value = 0.0;
+                try {
+                    value = std::stod(argv[++i]);
+                } catch (const std::exception&) {
+                    std::cerr << "Error: invalid value '" << argv[i] << "' for " << arg << std::endl;
+                    return 1;
+                }
+                if (value < 0.0 || (arg == "--gap" && value >= 1.0)) {
+                    std::cerr << "Error: " << arg << (arg == "--gap" ? " must be in [0,1)" : " must be >= 0")
+                              << std::endl;
+                    return 1;
+                }
+                if (arg == "--time-limit") {
+                    limits.time_limit = value;
+                } else if (arg == "--memory-limit") {
+                    memory_limit_mb = value;
+                } else if (arg == "--iso-time-limit") {
+                    embedding_time_limit = value;
+                } else if (arg == "--node-limit") {
+                    limits.node_limit = static_cast<int>(std::min(value, static_cast<double>(INT_MAX)));
+                } else {
+                    limits.gap = value;
+                }
             } else if (arg == "--output" || arg == "-o") {
                 if (i + 1 >= argc) {
                     std::cerr << "Error: missing value after '" << arg << "'" << std::endl;
                     return 1;
                 }
                 output_file = argv[++i];
+            } else if (arg == "--write-model" || arg == "--model-cache") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: missing value after '" << arg << "'" << std::endl;
+                    return 1;
+                }
+                (arg == "--write-model" ? model_file : cache_dir) = argv[++i];
             } else if (input_file.empty()) {
                 input_file = arg;
             } else {
@@ -205,15 +474,49 @@ int main(int argc, char* argv[]) {
             std::cerr << "  Second graph (target):" << std::endl;
             std::cerr << "    Line 1: number of vertices" << std::endl;
             std::cerr << "    Following lines: adjacency matrix (0 or 1)" << std::endl;
+            std::cerr << "  Either graph may be an edge list instead:" << std::endl;
+            std::cerr << "    Line 1: <vertices> edges <m>" << std::endl;
+            std::cerr << "    Following m lines: <src> <dst> [<multiplicity>]" << std::endl;
+            std::cerr << "  A line 'directed' or 'undirected' may follow a graph to declare its type" << std::endl;
             std::cerr << std::endl;
             std::cerr << "Options:" << std::endl;
             std::cerr << "  --time, -t    Show computation time in milliseconds" << std::endl;
+            std::cerr << "  --stats       Show parse/build/solve times, model size and peak memory" << std::endl;
             std::cerr << "  --ged, -g     Solve full graph edit distance (default: minimal extension)" << std::endl;
             std::cerr << "  --f2lp, --lp  Solve GED using the F2 linear relaxation (lower bound)" << std::endl;
+            std::cerr << "  --bipartite   GED upper and lower bounds from one vertex assignment (fast)" << std::endl;
             std::cerr << "  --up,  -u v   Upper-bound pruning parameter in (0,1] for GED (default 1.0)" << std::endl;
             std::cerr << "  --fast, -f    Use greedy heuristic (fast approximation, upper bound)" << std::endl;
             std::cerr << "  --minext-approx  GED F2LP with huge deletion cost (approximate minimal extension)" << std::endl;
             std::cerr << "  --output, -o  Write solution XML to the given file (GEM++ style)" << std::endl;
+            std::cerr << "  --multi, -m   Keep matrix values as edge multiplicities (one integer edge" << std::endl;
+            std::cerr << "                variable per vertex pair instead of one per parallel edge)" << std::endl;
+            std::cerr << "  --directed    Treat symmetric matrices as directed graphs (default: undirected)" << std::endl;
+            std::cerr << "  --time-limit s   Stop the search after s seconds and report the best solution," << std::endl;
+            std::cerr << "                   its bound and gap (Ctrl-C does the same; inf if none was found)" << std::endl;
+            std::cerr << "  --node-limit n   Stop the search after n branch-and-bound nodes (--mcs: counted" << std::endl;
+            std::cerr << "                   from the first solution on)" << std::endl;
+            std::cerr << "  --gap g          Stop once (solution - bound) / solution <= g (default 1e-9)" << std::endl;
+            std::cerr << "  --no-warm-start  Exact modes: do not seed branch and bound with the greedy solution" << std::endl;
+            std::cerr << "  --no-rounding    Exact modes: do not round the node relaxations to matchings" << std::endl;
+            std::cerr << "  --lazy           Add the F2 edge consistency rows on demand, when violated" << std::endl;
+            std::cerr << "  --mcs            Exact minimal extension or GED by common subgraph search (no ILP)" << std::endl;
+            std::cerr << "  --astar          --mcs with best-first (A*) search" << std::endl;
+            std::cerr << "  --memory-limit m Open nodes of --astar kept within m MB (default 1024), then depth-first" << std::endl;
+            std::cerr << "  --no-bitset      Exact modes: use the ILP even for simple graphs of up to 128 vertices" << std::endl;
+            std::cerr << "  --no-iso         Minimal extension: skip the subgraph isomorphism test before solving" << std::endl;
+            std::cerr << "  --iso-time-limit s  Budget of that test in seconds (default 1)" << std::endl;
+            std::cerr << "  --write-model f  Write the built model to f (CPLEX LP if f ends in .lp, else MPS)" << std::endl;
+            std::cerr << "  --model-cache d  Reuse models built for the same input and settings, kept in d" << std::endl;
+            return 1;
+        }
+
+        if (use_mcs && use_f2lp) {
+            std::cerr << "Error: --mcs solves integer problems, not the F2 relaxation" << std::endl;
+            return 1;
+        }
+        if (use_bipartite && (use_mcs || use_f2lp)) {
+            std::cerr << "Error: --bipartite does not combine with --mcs, --astar or --f2lp" << std::endl;
             return 1;
         }
 
@@ -221,19 +524,19 @@ int main(int argc, char* argv[]) {
         auto start_time = std::chrono::high_resolution_clock::now();
 
         // Parse input file containing both graphs
-        auto graphs = AdjacencyMatrixParser::parseFile(input_file);
+        AdjacencyMatrixParser::Options parse_options;
+        parse_options.edgeMode = keep_multiplicity ? AdjacencyMatrixParser::KEEP_MULTIPLICITY
+                                                   : AdjacencyMatrixParser::EXPAND_MULTIPLICITY;
+        parse_options.detectUndirected = !force_directed;
+        auto graphs = AdjacencyMatrixParser::parseFile(input_file, parse_options);
         Graph* pattern = graphs.first;
         Graph* target = graphs.second;
+        auto parse_time = std::chrono::high_resolution_clock::now();
 
         // Create problem
         Problem::Type problem_type = use_ged ? Problem::GED : Problem::SUBGRAPH;
         Problem problem(problem_type, pattern, target);
 
-        int nVP = pattern->getVertexCount();
-        int nVT = target->getVertexCount();
-        int nEP = pattern->getEdgeCount();
-        int nET = target->getEdgeCount();
-
         if (use_ged) {
             // GED formulation
             LinearGraphEditDistance formulation(&problem);
@@ -245,13 +548,79 @@ int main(int argc, char* argv[]) {
                     /*edge_insertion=*/1.0,
                     /*edge_deletion=*/HIGH_DELETION_COST);
             }
-            formulation.init(upper_bound, use_f2lp);
-
             GLPKSolver solver;
-            solver.init(formulation.getLinearProgram(), false, use_f2lp, first_feasible);
+            std::unique_ptr<MCSSolver> search;
+            Matching matching(&problem);
+            auto build_time = parse_time;
+            // Small simple graphs skip the ILP unless a model is asked for
+            int bit_width = use_bitset && !use_f2lp && !use_bipartite && !use_mcs && !first_feasible &&
+                                    !lazy_edges && upper_bound >= 1.0 && model_file.empty() &&
+                                    cache_dir.empty()
+                                ? bitParallelWidth(&problem)
+                                : 0;
+            long bit_nodes = 0;
+            if (use_bipartite) {
+                BipartiteGED bipartite(&problem);
+                build_time = std::chrono::high_resolution_clock::now();
+                matching = bipartite.solve();
+            } else if (use_mcs) {
+                // Combinatorial search; --fast stops it at its first incumbent
+                search.reset(new MCSSolver(&problem));
+                LowerBounds bounds;
+                formulation.addBoundProviders(bounds);
+                configureSearch(*search, &problem, bounds, warm_start, best_first, memory_limit_mb);
+                build_time = std::chrono::high_resolution_clock::now();
+
+                applyLimits(*search, limits);
+                if (first_feasible) search->setNodeLimit(1);
+                matching = solveInterruptible(*search);
+            } else if (bit_width > 0) {
+                LowerBounds bounds;
+                formulation.addBoundProviders(bounds);
+                build_time = std::chrono::high_resolution_clock::now();
+                matching = solveBitParallel(&problem, bit_width, bounds.get(), warm_start, limits, bit_nodes);
+            } else {
+                // Constraints are streamed straight into GLPK while the formulation is built,
+                // unless the model is found in the cache
+                std::ostringstream settings;
+                settings << (approx_minext ? "minext-approx" : (use_f2lp ? "f2lp" : "ged"))
+                         << " up=" << std::setprecision(17) << upper_bound << (lazy_edges ? " lazy" : "");
+                std::string cache_file = modelCachePath(cache_dir, pattern, target, settings.str());
+                if (!loadCachedModel(solver, &problem, cache_file, use_f2lp, first_feasible)) {
+                    formulation.setLazyEdgeConstraints(lazy_edges);
+                    formulation.init(upper_bound, use_f2lp, &solver);
+                    solver.init(formulation.getLinearProgram(), false, use_f2lp, first_feasible);
+                    if (!cache_file.empty()) solver.writeModel(cache_file);
+                }
+                if (!model_file.empty()) solver.writeModel(model_file);
+                EdgeConsistency consistency(&problem);
+                if (lazy_edges) {
+                    solver.setSeparator(
+                        [&consistency](const std::vector<double>& values, ConstraintStore& rows) {
+                            consistency.separate(values, rows);
+                        });
+                }
+                if (!use_f2lp) {
+                    LowerBounds bounds;
+                    formulation.addBoundProviders(bounds);
+                    solver.setLowerBound(bounds.get());
+                }
+                if (warm_start && !use_f2lp && !first_feasible) {
+                    GreedySolver greedy(&problem);
+                    solver.setWarmStart(greedy.solve().toColumns());
+                }
+                LPRounding rounding(&problem);
+                if (lp_rounding && !use_f2lp && !first_feasible) {
+                    solver.setRounding([&rounding](const std::vector<double>& relaxation) {
+                        return rounding.round(relaxation);
+                    });
+                }
+                build_time = std::chrono::high_resolution_clock::now();
 
-            std::unordered_map<std::string, double> solution;
-            double objective = solver.solve(solution);
+                applyLimits(solver, limits);
+                matching = solveInterruptible(solver, &problem);
+            }
+            double objective = matching.getObjective();
 
             // End timing
             auto end_time = std::chrono::high_resolution_clock::now();
@@ -260,65 +629,15 @@ int main(int argc, char* argv[]) {
             int ged_value = std::isinf(objective) ? -1 : static_cast<int>(std::round(objective));
             bool is_isomorphic = (use_f2lp ? (std::abs(objective) < 1e-6) : (ged_value == 0));
 
-            // Unmatched vertices (pattern and target)
-            std::vector<int> unmatched_pattern_vertices;
-            std::vector<int> unmatched_target_vertices;
-            for (int i = 0; i < nVP; ++i) {
-                bool matched = false;
-                for (int k = 0; k < nVT; ++k) {
-                    std::string var_id = "x_" + std::to_string(i) + "," + std::to_string(k);
-                    if (solution.count(var_id) && solution[var_id] >= 0.5) {
-                        matched = true;
-                        break;
-                    }
-                }
-                if (!matched) {
-                    unmatched_pattern_vertices.push_back(i);
-                }
-            }
-            for (int k = 0; k < nVT; ++k) {
-                bool matched = false;
-                for (int i = 0; i < nVP; ++i) {
-                    std::string var_id = "x_" + std::to_string(i) + "," + std::to_string(k);
-                    if (solution.count(var_id) && solution[var_id] >= 0.5) {
-                        matched = true;
-                        break;
-                    }
-                }
-                if (!matched) {
-                    unmatched_target_vertices.push_back(k);
-                }
-            }
-
-            // Unmatched edges (pattern and target)
-            std::vector<int> unmatched_pattern_edges;
-            std::vector<int> unmatched_target_edges;
-            for (int ij = 0; ij < nEP; ++ij) {
-                bool matched = false;
-                for (int kl = 0; kl < nET; ++kl) {
-                    std::string var_id = "y_" + std::to_string(ij) + "," + std::to_string(kl);
-                    if (solution.count(var_id) && solution[var_id] >= 0.5) {
-                        matched = true;
-                        break;
-                    }
-                }
-                if (!matched) {
-                    unmatched_pattern_edges.push_back(ij);
-                }
-            }
-            for (int kl = 0; kl < nET; ++kl) {
-                bool matched = false;
-                for (int ij = 0; ij < nEP; ++ij) {
-                    std::string var_id = "y_" + std::to_string(ij) + "," + std::to_string(kl);
-                    if (solution.count(var_id) && solution[var_id] == 1) {
-                        matched = true;
-                        break;
-                    }
-                }
-                if (!matched) {
-                    unmatched_target_edges.push_back(kl);
-                }
-            }
+            // Unmatched elements, ascending; edges as arcs sorted by (src, dst)
+            std::vector<int> unmatched_pattern_vertices = matching.getUnmatchedPatternVertices();
+            std::vector<int> unmatched_target_vertices = matching.getUnmatchedTargetVertices();
+            std::vector<std::pair<int, int>> unmatched_pattern_edge_list =
+                matching.getUnmatchedPatternArcs();
+            std::vector<std::pair<int, int>> unmatched_target_edge_list =
+                matching.getUnmatchedTargetArcs();
+            std::sort(unmatched_pattern_edge_list.begin(), unmatched_pattern_edge_list.end());
+            std::sort(unmatched_target_edge_list.begin(), unmatched_target_edge_list.end());
 
             // Output GED results
             if (use_f2lp) {
@@ -330,16 +649,11 @@ int main(int argc, char* argv[]) {
                               << (std::isinf(objective) ? "inf" : std::to_string(objective)) << std::endl;
                 }
             } else {
-                std::cout << "GED: " << (std::isinf(objective) ? "inf" : std::to_string(ged_value)) << std::endl;
+                std::cout << "GED: " << (std::isinf(objective) ? "inf" : std::to_string(ged_value))
+                          << matching.getBoundNote() << std::endl;
             }
             std::cout << "Is Isomorphic: " << (is_isomorphic ? "yes" : "no") << std::endl;
 
-            // Sorted unmatched elements for deterministic output
-            std::sort(unmatched_pattern_vertices.begin(), unmatched_pattern_vertices.end());
-            std::sort(unmatched_target_vertices.begin(), unmatched_target_vertices.end());
-            std::sort(unmatched_pattern_edges.begin(), unmatched_pattern_edges.end());
-            std::sort(unmatched_target_edges.begin(), unmatched_target_edges.end());
-
             std::cout << "Unmatched pattern vertices:";
             if (unmatched_pattern_vertices.empty()) {
                 std::cout << " none";
@@ -360,21 +674,6 @@ int main(int argc, char* argv[]) {
             }
             std::cout << std::endl;
 
-            // Collect and sort edges by (src, dst) preserving direction
-            std::vector<std::pair<int, int>> unmatched_pattern_edge_list;
-            for (int ij : unmatched_pattern_edges) {
-                Edge* e = pattern->getEdge(ij);
-                unmatched_pattern_edge_list.push_back({e->getOrigin()->getIndex(), e->getTarget()->getIndex()});
-            }
-            std::vector<std::pair<int, int>> unmatched_target_edge_list;
-            for (int kl : unmatched_target_edges) {
-                Edge* e = target->getEdge(kl);
-                unmatched_target_edge_list.push_back({e->getOrigin()->getIndex(), e->getTarget()->getIndex()});
-            }
-
-            std::sort(unmatched_pattern_edge_list.begin(), unmatched_pattern_edge_list.end());
-            std::sort(unmatched_target_edge_list.begin(), unmatched_target_edge_list.end());
-
             std::cout << "Unmatched pattern edges:";
             if (unmatched_pattern_edge_list.empty()) {
                 std::cout << " none";
@@ -396,7 +695,7 @@ int main(int argc, char* argv[]) {
             std::cout << std::endl;
 
             if (approx_minext) {
-                int approx_extension = static_cast<int>(unmatched_pattern_vertices.size() + unmatched_pattern_edges.size());
+                int approx_extension = static_cast<int>(unmatched_pattern_vertices.size() + unmatched_pattern_edge_list.size());
                 std::cout << "Approx minimal extension (pattern side, count): "
                           << approx_extension << std::endl;
             }
@@ -404,9 +703,18 @@ int main(int argc, char* argv[]) {
             if (show_time) {
                 std::cout << "Time: " << duration.count() << " ms" << std::endl;
             }
+            if (show_stats) {
+                printStats(elapsedMs(start_time, parse_time), elapsedMs(parse_time, build_time),
+                           elapsedMs(build_time, end_time), formulation.getLinearProgram(),
+                           search || use_bipartite || bit_width > 0 ? nullptr : &solver, search.get());
+                if (bit_width > 0) {
+                    std::cout << "Bit-parallel search (Bitset<" << bit_width << ">): " << bit_nodes
+                              << " nodes" << std::endl;
+                }
+            }
 
             if (!output_file.empty()) {
-                writeSolutionXML(output_file, &problem, solution, objective, true);
+                writeSolutionXML(output_file, &problem, matching, true);
             }
 
             // Cleanup
@@ -415,92 +723,133 @@ int main(int argc, char* argv[]) {
             return 0;
         }
 
-        std::unordered_map<std::string, double> solution;
-        double objective;
+        auto build_time = parse_time;
+        // Built model kept for --stats (no LP in fast mode or when read from the cache)
+        std::unique_ptr<MinimumCostSubgraphMatching> formulation;
+        GLPKSolver solver;
+        std::unique_ptr<MCSSolver> search;
+        Matching matching(&problem);
+
+        // Exact modes: an embedding is an extension of 0, found without a model; proving there
+        // is none raises the lower bound to 1
+        std::unique_ptr<SubgraphMatcher> matcher;
+        double embedding_bound = -INFINITY;
+        bool embedded = false;
+        if (try_embedding && !first_feasible) {
+            matcher.reset(new SubgraphMatcher(&problem));
+            matcher->setTimeLimit(embedding_time_limit);
+            matching = matcher->solve();
+            embedded = matching.hasSolution();
+            if (matching.getStatus() == Matching::INFEASIBLE) embedding_bound = matching.getBound();
+        }
 
-        if (first_feasible) {
+        // Small simple graphs skip the ILP unless a model is asked for
+        int bit_width = use_bitset && !use_mcs && !first_feasible && !lazy_edges &&
+                                model_file.empty() && cache_dir.empty()
+                            ? bitParallelWidth(&problem)
+                            : 0;
+        long bit_nodes = 0;
+
+        if (embedded) {
+            build_time = std::chrono::high_resolution_clock::now();
+        } else if (use_mcs) {
+            // Combinatorial search, with the bounds and warm start of the ILP; --fast stops it
+            // at its first incumbent, as for GED
+            search.reset(new MCSSolver(&problem));
+            LowerBounds bounds;
+            MinimumCostSubgraphMatching(&problem, false).addBoundProviders(bounds);
+            configureSearch(*search, &problem, bounds, warm_start, best_first, memory_limit_mb);
+            search->setLowerBound(std::max(bounds.get(), embedding_bound));
+            build_time = std::chrono::high_resolution_clock::now();
+
+            applyLimits(*search, limits);
+            if (first_feasible) search->setNodeLimit(1);
+            matching = solveInterruptible(*search);
+        } else if (first_feasible) {
             // Use fast greedy solver for approximation
             GreedySolver greedy(&problem);
-            auto result = greedy.solve();
-            solution = std::move(result.solution);
-            objective = result.objective;
+            matching = greedy.solve();
+        } else if (bit_width > 0) {
+            LowerBounds bounds;
+            MinimumCostSubgraphMatching(&problem, false).addBoundProviders(bounds);
+            build_time = std::chrono::high_resolution_clock::now();
+            matching = solveBitParallel(&problem, bit_width, std::max(bounds.get(), embedding_bound),
+                                        warm_start, limits, bit_nodes);
         } else {
             // Create MCSM formulation (allows partial matches)
-            MinimumCostSubgraphMatching formulation(&problem, false);
-            formulation.init();
-
-            // Solve with GLPK
-            GLPKSolver solver;
-            solver.init(formulation.getLinearProgram(), false, false, false);
-
-            objective = solver.solve(solution);
-        }
-
-        // End timing
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-
-        // Determine which pattern vertices are unmatched
-        std::vector<int> unmatched_vertices;
-        for (int i = 0; i < nVP; ++i) {
-            bool matched = false;
-            for (int k = 0; k < nVT; ++k) {
-                std::string var_id = "x_" + std::to_string(i) + "," + std::to_string(k);
-                if (solution.count(var_id) && solution[var_id] >= 0.5) {
-                    matched = true;
-                    break;
-                }
+            formulation.reset(new MinimumCostSubgraphMatching(&problem, false));
+
+            // Solve with GLPK; constraints are streamed into it while the formulation is built,
+            // unless the model is found in the cache
+            std::string cache_file = modelCachePath(cache_dir, pattern, target,
+                                                    lazy_edges ? "minext lazy" : "minext");
+            if (!loadCachedModel(solver, &problem, cache_file, false, false)) {
+                formulation->setLazyEdgeConstraints(lazy_edges);
+                formulation->init(1.0, &solver);
+                solver.init(formulation->getLinearProgram(), false, false, false);
+                if (!cache_file.empty()) solver.writeModel(cache_file);
             }
-            if (!matched) {
-                unmatched_vertices.push_back(i);
+            if (!model_file.empty()) solver.writeModel(model_file);
+            EdgeConsistency consistency(&problem);
+            if (lazy_edges) {
+                solver.setSeparator(
+                    [&consistency](const std::vector<double>& values, ConstraintStore& rows) {
+                        consistency.separate(values, rows);
+                    });
             }
-        }
-
-        // Determine which pattern edges are unmatched
-        std::vector<int> unmatched_edges;
-        for (int ij = 0; ij < nEP; ++ij) {
-            bool matched = false;
-            for (int kl = 0; kl < nET; ++kl) {
-                std::string var_id = "y_" + std::to_string(ij) + "," + std::to_string(kl);
-                if (solution.count(var_id) && solution[var_id] >= 0.5) {
-                    matched = true;
-                    break;
-                }
+            LowerBounds bounds;
+            formulation->addBoundProviders(bounds);
+            solver.setLowerBound(std::max(bounds.get(), embedding_bound));
+            if (warm_start) {
+                // Greedy matching as the first incumbent
+                GreedySolver greedy(&problem);
+                solver.setWarmStart(greedy.solve().toColumns());
             }
-            if (!matched) {
-                unmatched_edges.push_back(ij);
+            LPRounding rounding(&problem);
+            if (lp_rounding) {
+                // Node relaxations rounded to matchings as further incumbents
+                solver.setRounding([&rounding](const std::vector<double>& relaxation) {
+                    return rounding.round(relaxation);
+                });
             }
-        }
-
-        // Compute results
-        bool is_subgraph = (objective < 1e-6);
-        int minimal_extension = std::isinf(objective) ? -1 : static_cast<int>(std::round(objective));
+            build_time = std::chrono::high_resolution_clock::now();
 
-        // Sort unmatched vertices
-        std::sort(unmatched_vertices.begin(), unmatched_vertices.end());
-
-        // Collect and sort edges by (src, dst) preserving direction
-        std::vector<std::pair<int, int>> edge_list;
-        for (int ij : unmatched_edges) {
-            Edge* e = pattern->getEdge(ij);
-            int src = e->getOrigin()->getIndex();
-            int dst = e->getTarget()->getIndex();
-            edge_list.push_back({src, dst});
+            applyLimits(solver, limits);
+            matching = solveInterruptible(solver, &problem);
         }
-        std::sort(edge_list.begin(), edge_list.end());
+
+        // End timing
+        auto end_time = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
 
         // Render output
-        GraphCanvas::renderMatchingResult(pattern, target,
-                                          unmatched_vertices, edge_list,
-                                          minimal_extension, is_subgraph);
+        GraphCanvas::renderMatchingResult(pattern, target, matching);
 
         // Output timing if requested
         if (show_time) {
             std::cout << "Time: " << duration.count() << " ms" << std::endl;
         }
+        if (show_stats) {
+            printStats(elapsedMs(start_time, parse_time), elapsedMs(parse_time, build_time),
+                       elapsedMs(build_time, end_time),
+                       formulation ? formulation->getLinearProgram() : nullptr,
+                       first_feasible || search || embedded || bit_width > 0 ? nullptr : &solver,
+                       search.get());
+            if (bit_width > 0 && !embedded) {
+                std::cout << "Bit-parallel search (Bitset<" << bit_width << ">): " << bit_nodes
+                          << " nodes" << std::endl;
+            }
+            if (matcher) {
+                std::cout << "Subgraph isomorphism: "
+                          << (embedded ? "embedding found"
+                                       : (std::isfinite(embedding_bound) ? "none (lower bound 1)"
+                                                                         : "budget exhausted"))
+                          << ", " << matcher->getNodeCount() << " nodes" << std::endl;
+            }
+        }
 
         if (!output_file.empty()) {
-            writeSolutionXML(output_file, &problem, solution, objective, false);
+            writeSolutionXML(output_file, &problem, matching, false);
         }
 
         // Cleanup
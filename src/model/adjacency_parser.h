@@ -3,145 +3,563 @@
 
 #include "graph.h"
 #include "../core/types.h"
-#include <fstream>
-#include <sstream>
+#include "../core/mapped_file.h"
+#include "../core/gzip_decoder.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GEMPP_PARSER_SSE2 1
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 namespace gempp {
 
+// Zero-copy parser for the task's adjacency-matrix format.
+//
+// Each graph may alternatively be given as a sparse edge list by adding the keyword
+// `edges` and the number of edge lines after the vertex count (see parseEdgeList).
+//
+// Graphs are UNDIRECTED when both adjacency matrices are symmetric (one edge per {i,j}),
+// DIRECTED otherwise. A line `directed` or `undirected` directly after a graph declares its
+// type; `directed` keeps the directed model even for symmetric input.
+//
+// The input is memory-mapped (or taken from a caller-owned buffer) and scanned in place:
+// no per-line or per-token strings are created. Matrix rows are located with memchr and
+// then tokenized straight into a flat n*n buffer from which the CSR graph is built; for large matrices the rows are split
+// into contiguous ranges parsed on separate threads. Validation errors are the same as
+// those of the original line/token based parser and always refer to the first bad row.
 class AdjacencyMatrixParser {
 public:
-    static std::pair<Graph*, Graph*> parseFile(const std::string& filename) {
-        // Read entire file
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            throw Exception("Cannot open file: " + filename);
+    // How an entry k > 1 of the adjacency matrix is turned into edges
+    enum EdgeMode {
+        EXPAND_MULTIPLICITY = 0,   // k parallel edges
+        KEEP_MULTIPLICITY          // one edge of multiplicity k
+    };
+
+    struct Options {
+        Options() : edgeMode(EXPAND_MULTIPLICITY), detectUndirected(true) {}
+
+        EdgeMode edgeMode;
+        bool detectUndirected;  // false: always build DIRECTED graphs
+    };
+
+    static std::pair<Graph*, Graph*> parseFile(const std::string& filename,
+                                               const Options& options = Options()) {
+        MappedFile file(filename);
+
+        // gzip input (detected by magic bytes, typically *.gz) is inflated in memory
+        if (GzipDecoder::isGzip(file.data(), file.size())) {
+            std::vector<char> text;
+            GzipDecoder::decompress(file.data(), file.size(), text, filename);
+            return parseBuffer(text.data(), text.size(), options);
         }
 
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        std::string data = buffer.str();
+        return parseBuffer(file.data(), file.size(), options);
+    }
+
+    static std::pair<Graph*, Graph*> parseData(const std::string& data,
+                                               const Options& options = Options()) {
+        return parseBuffer(data.data(), data.size(), options);
+    }
+
+    static std::pair<Graph*, Graph*> parseBuffer(const char* data, size_t size,
+                                                 const Options& options = Options()) {
+        const char* end = data + size;
+
+        // Need at least the two vertex count lines
+        LineCursor probe(data, end);
+        Span line;
+        if (!probe.next(line) || !probe.next(line)) {
+            throw Exception("File must contain at least two graphs (vertex count lines)");
+        }
+
+        LineCursor cursor(data, end);
+
+        // Parse both graphs
+        ParsedGraph parsed1 = parseSingleGraph(cursor, 0);
+        ParsedGraph parsed2 = parseSingleGraph(cursor, 1);
 
-        return parseData(data);
+        // Undirected only if neither graph is declared directed and both are symmetric
+        Graph::Type type = Graph::DIRECTED;
+        if (options.detectUndirected &&
+            parsed1.declared != DECLARED_DIRECTED && parsed2.declared != DECLARED_DIRECTED &&
+            parsed1.symmetric && parsed2.symmetric) {
+            type = Graph::UNDIRECTED;
+        }
+
+        Graph* graph1 = buildGraph(parsed1, type, options.edgeMode, 0);
+        return std::make_pair(graph1, buildGraph(parsed2, type, options.edgeMode, 1));
     }
 
-    static std::pair<Graph*, Graph*> parseData(const std::string& data) {
-        // Split into lines
-        std::vector<std::string> lines = StringUtils::split(data, '\n', false);
+    // Number of threads used for large matrices (0 = hardware concurrency).
+    static void setThreadCount(int threads) { threadCountSetting() = threads; }
+
+private:
+    // Header keyword selecting the sparse edge-list format: "<n> edges <m>"
+    static constexpr const char* EDGE_LIST_KEYWORD = "edges";
+
+    // Matrices smaller than this many bytes are always parsed on the calling thread.
+    static constexpr size_t PARALLEL_THRESHOLD = 1 << 22;
+
+    // Header keywords declaring the type of the preceding graph
+    static constexpr const char* DIRECTED_KEYWORD = "directed";
+    static constexpr const char* UNDIRECTED_KEYWORD = "undirected";
+
+    struct Span {
+        const char* begin;
+        const char* end;
+    };
+
+    enum Declaration {
+        DECLARED_NONE,
+        DECLARED_DIRECTED,
+        DECLARED_UNDIRECTED
+    };
 
-        // Remove empty lines and trim whitespace
-        std::vector<std::string> trimmed_lines;
-        for (const auto& line : lines) {
-            std::string trimmed = StringUtils::trim(line);
-            if (!trimmed.empty()) {
-                trimmed_lines.push_back(trimmed);
+    struct Arc {
+        int src;
+        int dst;
+        int weight;
+    };
+
+    // A graph as read from the file, before its type is decided
+    struct ParsedGraph {
+        int vertexCount;
+        std::vector<Arc> arcs;      // sorted by (src, dst), one per vertex pair, weight > 0
+        bool symmetric;
+        Declaration declared;
+    };
+
+    // Iterates over non-blank lines, trimmed of surrounding whitespace
+    class LineCursor {
+    public:
+        LineCursor(const char* begin, const char* end) : pos_(begin), end_(end) {}
+
+        // Like next(), but does not advance
+        bool peek(Span& line) const {
+            LineCursor copy = *this;
+            return copy.next(line);
+        }
+
+        bool next(Span& line) {
+            while (pos_ < end_) {
+                const char* nl = static_cast<const char*>(std::memchr(pos_, '\n', end_ - pos_));
+                const char* stop = nl ? nl : end_;
+                const char* b = pos_;
+                const char* e = stop;
+                pos_ = nl ? nl + 1 : end_;
+
+                while (b < e && isSpace(*b)) ++b;
+                while (e > b && isSpace(*(e - 1))) --e;
+                if (b < e) {
+                    line.begin = b;
+                    line.end = e;
+                    return true;
+                }
             }
+            return false;
         }
 
-        if (trimmed_lines.size() < 2) {
-            throw Exception("File must contain at least two graphs (vertex count lines)");
+    private:
+        const char* pos_;
+        const char* end_;
+    };
+
+    enum TokenStatus {
+        TOKEN_OK,
+        TOKEN_INVALID,
+        TOKEN_NEGATIVE
+    };
+
+    static int& threadCountSetting() {
+        static int threads = 0;
+        return threads;
+    }
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+    }
+
+    static int countTrailingZeros(uint32_t x) {
+#ifdef _MSC_VER
+        unsigned long idx;
+        _BitScanForward(&idx, x);
+        return static_cast<int>(idx);
+#else
+        return __builtin_ctz(x);
+#endif
+    }
+
+    // Parses an optionally signed decimal integer spanning exactly [b, e)
+    static TokenStatus parseToken(const char* b, const char* e, int& value) {
+        bool negative = false;
+        if (*b == '+' || *b == '-') {
+            negative = (*b == '-');
+            ++b;
+        }
+        if (b == e) return TOKEN_INVALID;
+
+        int64_t acc = 0;
+        for (; b < e; ++b) {
+            unsigned d = static_cast<unsigned>(*b - '0');
+            if (d > 9) return TOKEN_INVALID;
+            acc = acc * 10 + d;
+            if (acc > 2147483648LL) return TOKEN_INVALID;
+        }
+        if (negative) acc = -acc;
+        if (acc > 2147483647LL) return TOKEN_INVALID;
+
+        value = static_cast<int>(acc);
+        return negative && value != 0 ? TOKEN_NEGATIVE : TOKEN_OK;
+    }
+
+    // Tokenizes one matrix row into out[0..n). Returns false and sets `error` on failure.
+    static bool parseRow(const char* p, const char* e, int n, int* out,
+                         int row, int graphIndex, std::string& error)
+    {
+        int count = 0;
+
+#ifdef GEMPP_PARSER_SSE2
+        // Vectorized fast path for rows of single-digit entries ("0 1 0 2 ...").
+        // A 16-byte block is consumed at once when it contains only spaces and isolated
+        // digits; anything else (multi-digit values, signs, garbage) drops to the scalar loop.
+        // Blocks are always entered at a token boundary.
+        const __m128i spaces = _mm_set1_epi8(' ');
+        const __m128i zeros = _mm_set1_epi8('0');
+        const __m128i flip = _mm_set1_epi8(static_cast<char>(0x80));
+        const __m128i ten = _mm_set1_epi8(static_cast<char>(10 ^ 0x80));
+        alignas(16) unsigned char digits[16];
+
+        while (e - p >= 16 && n - count >= 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i values = _mm_sub_epi8(chunk, zeros);
+            uint32_t d = static_cast<uint32_t>(_mm_movemask_epi8(
+                _mm_cmplt_epi8(_mm_xor_si128(values, flip), ten)));
+            uint32_t s = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, spaces)));
+
+            if ((d | s) != 0xFFFF) break;
+            if (d & (d >> 1)) break;
+            if ((d & 0x8000) && e - p > 16 && p[16] != ' ') break;
+
+            _mm_store_si128(reinterpret_cast<__m128i*>(digits), values);
+            while (d) {
+                out[count++] = digits[countTrailingZeros(d)];
+                d &= d - 1;
+            }
+            p += 16;
         }
+#endif
 
-        // Parse first graph
-        auto firstGraphResult = parseSingleGraph(trimmed_lines, 0, 0);
-        Graph* graph1 = firstGraphResult.first;
-        int nextLine = firstGraphResult.second;
+        int badColumn = -1;
+        TokenStatus badStatus = TOKEN_OK;
+        int badValue = 0;
+        const char* badBegin = nullptr;
+        const char* badEnd = nullptr;
 
-        // Parse second graph
-        auto secondGraphResult = parseSingleGraph(trimmed_lines, nextLine, 1);
-        Graph* graph2 = secondGraphResult.first;
+        while (p < e) {
+            if (*p == ' ') {
+                ++p;
+                continue;
+            }
+            const char* t = p;
+            while (p < e && *p != ' ') ++p;
 
-        return std::make_pair(graph1, graph2);
+            if (count < n && badColumn < 0) {
+                int value = 0;
+                TokenStatus status = parseToken(t, p, value);
+                if (status == TOKEN_OK) {
+                    out[count] = value;
+                } else {
+                    badColumn = count;
+                    badStatus = status;
+                    badValue = value;
+                    badBegin = t;
+                    badEnd = p;
+                }
+            }
+            ++count;
+        }
+
+        if (count != n) {
+            error = "Adjacency matrix row " + std::to_string(row + 1) +
+                    " of graph " + std::to_string(graphIndex + 1) +
+                    " has " + std::to_string(count) +
+                    " values, expected " + std::to_string(n);
+            return false;
+        }
+
+        if (badColumn >= 0) {
+            std::string position = "at position (" + std::to_string(row + 1) + "," +
+                                   std::to_string(badColumn + 1) + ") in graph " +
+                                   std::to_string(graphIndex + 1);
+            if (badStatus == TOKEN_INVALID) {
+                error = "Invalid adjacency matrix value '" + std::string(badBegin, badEnd) +
+                        "' " + position;
+            } else {
+                error = "Adjacency matrix value " + std::to_string(badValue) + " " +
+                        position + " must be non-negative";
+            }
+            return false;
+        }
+
+        return true;
     }
 
-private:
-    static std::pair<Graph*, int> parseSingleGraph(
-        const std::vector<std::string>& lines,
-        int startLine,
-        int graphIndex)
+    // Parses rows [first, last) and stops at the first invalid one
+    static void parseRowRange(const std::vector<Span>& rows, int first, int last, int n,
+                              int* matrix, int graphIndex, std::string& error)
     {
-        if (startLine >= (int)lines.size()) {
+        for (int i = first; i < last; ++i) {
+            int* out = matrix + static_cast<size_t>(i) * n;
+            if (!parseRow(rows[i].begin, rows[i].end, n, out, i, graphIndex, error)) {
+                return;
+            }
+        }
+    }
+
+    static void parseRows(const std::vector<Span>& rows, int n, int* matrix, int graphIndex) {
+        size_t bytes = static_cast<size_t>(rows.back().end - rows.front().begin);
+
+        int threads = threadCountSetting();
+        if (threads <= 0) {
+            threads = static_cast<int>(std::thread::hardware_concurrency());
+        }
+        if (threads > n) threads = n;
+
+        if (threads <= 1 || bytes < PARALLEL_THRESHOLD) {
+            std::string error;
+            parseRowRange(rows, 0, n, n, matrix, graphIndex, error);
+            if (!error.empty()) throw Exception(error);
+            return;
+        }
+
+        // Contiguous row ranges; errors are reported for the lowest failing row
+        std::vector<std::string> errors(threads);
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (int t = 0; t < threads; ++t) {
+            int first = static_cast<int>(static_cast<int64_t>(n) * t / threads);
+            int last = static_cast<int>(static_cast<int64_t>(n) * (t + 1) / threads);
+            workers.emplace_back(parseRowRange, std::cref(rows), first, last, n,
+                                 matrix, graphIndex, std::ref(errors[t]));
+        }
+        for (auto& w : workers) w.join();
+
+        for (const auto& error : errors) {
+            if (!error.empty()) throw Exception(error);
+        }
+    }
+
+    // True if every arc (s, d, w) has a reverse arc (d, s, w)
+    static bool isSymmetric(const std::vector<Arc>& arcs) {
+        auto less = [](const Arc& a, const Arc& b) {
+            return a.src != b.src ? a.src < b.src : a.dst < b.dst;
+        };
+        for (const Arc& a : arcs) {
+            if (a.src == a.dst) continue;
+            Arc reverse = {a.dst, a.src, 0};
+            auto it = std::lower_bound(arcs.begin(), arcs.end(), reverse, less);
+            if (it == arcs.end() || it->src != a.dst || it->dst != a.src || it->weight != a.weight) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Consumes an optional `directed` / `undirected` line following a graph
+    static Declaration parseDeclaration(LineCursor& cursor) {
+        Span line;
+        if (!cursor.peek(line) || line.end - line.begin > 16) return DECLARED_NONE;
+        std::string word = StringUtils::toLower(std::string(line.begin, line.end));
+        if (word == DIRECTED_KEYWORD) {
+            cursor.next(line);
+            return DECLARED_DIRECTED;
+        }
+        if (word == UNDIRECTED_KEYWORD) {
+            cursor.next(line);
+            return DECLARED_UNDIRECTED;
+        }
+        return DECLARED_NONE;
+    }
+
+    // Undirected graphs get one edge per {src, dst} pair, stored with src <= dst
+    static Graph* buildGraph(const ParsedGraph& parsed, Graph::Type type, EdgeMode mode,
+                             int graphIndex) {
+        Graph::Builder builder(parsed.vertexCount, type);
+        builder.setID("graph_" + std::to_string(graphIndex));
+        for (const Arc& a : parsed.arcs) {
+            if (type == Graph::UNDIRECTED && a.src > a.dst) continue;
+            if (mode == KEEP_MULTIPLICITY) {
+                builder.addEdge(a.src, a.dst, a.weight);
+            } else {
+                builder.addEdges(a.src, a.dst, a.weight);
+            }
+        }
+        return builder.build();
+    }
+
+    static ParsedGraph parseSingleGraph(LineCursor& cursor, int graphIndex) {
+        ParsedGraph parsed;
+        parsed.vertexCount = readGraph(cursor, graphIndex, parsed.arcs);
+        parsed.symmetric = isSymmetric(parsed.arcs);
+        parsed.declared = parseDeclaration(cursor);
+        if (parsed.declared == DECLARED_UNDIRECTED && !parsed.symmetric) {
+            throw Exception("Graph " + std::to_string(graphIndex + 1) +
+                          " is declared undirected but its adjacency matrix is not symmetric");
+        }
+        return parsed;
+    }
+
+    // Reads one graph in either format into `arcs`; returns its vertex count
+    static int readGraph(LineCursor& cursor, int graphIndex, std::vector<Arc>& arcs) {
+        Span header;
+        if (!cursor.next(header)) {
             throw Exception("Unexpected end of file while parsing graph " +
                           std::to_string(graphIndex + 1));
         }
 
+        // Header: "<n>" (adjacency matrix) or "<n> edges <m>" (edge list)
+        std::string headerText(header.begin, header.end);
+        std::vector<std::string> fields = StringUtils::split(headerText, ' ', true);
+        bool edgeList = (fields.size() == 3 && fields[1] == EDGE_LIST_KEYWORD);
+        std::string countText = edgeList ? fields[0] : headerText;
+
         // Read number of vertices
         bool ok;
-        int vertexCount = StringUtils::toInt(lines[startLine], &ok);
+        int vertexCount = StringUtils::toInt(countText, &ok);
         if (!ok || vertexCount <= 0) {
-            throw Exception("Invalid vertex count '" + lines[startLine] +
+            throw Exception("Invalid vertex count '" + countText +
                           "' for graph " + std::to_string(graphIndex + 1));
         }
 
-        int currentLine = startLine + 1;
-
-        // Read adjacency matrix
-        if (currentLine + vertexCount > (int)lines.size()) {
-            throw Exception("Not enough lines for adjacency matrix of graph " +
-                          std::to_string(graphIndex + 1));
+        if (edgeList) {
+            int edgeLines = StringUtils::toInt(fields[2], &ok);
+            if (!ok || edgeLines < 0) {
+                throw Exception("Invalid edge count '" + fields[2] +
+                              "' for graph " + std::to_string(graphIndex + 1));
+            }
+            parseEdgeList(cursor, vertexCount, edgeLines, graphIndex, arcs);
+            return vertexCount;
         }
 
-        // Create graph as DIRECTED; adjacency matrix entries denote arc multiplicity
-        Graph* graph = new Graph(Graph::DIRECTED);
-        graph->setID("graph_" + std::to_string(graphIndex));
-
-        // Add vertices
+        // Locate adjacency matrix rows
+        std::vector<Span> rows(vertexCount);
         for (int i = 0; i < vertexCount; ++i) {
-            Vertex* v = new Vertex();
-            graph->addVertex(v, std::to_string(i));
+            if (!cursor.next(rows[i])) {
+                throw Exception("Not enough lines for adjacency matrix of graph " +
+                              std::to_string(graphIndex + 1));
+            }
         }
 
         // Parse adjacency matrix values (no symmetry required; directed multigraph)
-        std::vector<std::vector<int>> matrix(vertexCount, std::vector<int>(vertexCount, 0));
+        std::vector<int> matrix(static_cast<size_t>(vertexCount) * vertexCount);
+        parseRows(rows, vertexCount, matrix.data(), graphIndex);
+
+        // Adjacency matrix entries denote arc multiplicity (supports multigraphs and self-loops)
         for (int i = 0; i < vertexCount; ++i) {
-            std::string line = lines[currentLine + i];
-            std::vector<std::string> values = StringUtils::split(line, ' ', true);
+            const int* row = matrix.data() + static_cast<size_t>(i) * vertexCount;
+            for (int j = 0; j < vertexCount; ++j) {
+                if (row[j] > 0) arcs.push_back({i, j, row[j]});
+            }
+        }
 
-            if ((int)values.size() != vertexCount) {
-                throw Exception("Adjacency matrix row " + std::to_string(i + 1) +
-                              " of graph " + std::to_string(graphIndex + 1) +
-                              " has " + std::to_string(values.size()) +
-                              " values, expected " + std::to_string(vertexCount));
+        return vertexCount;
+    }
+
+    // Sparse format: one "<src> <dst> [<multiplicity>]" line per vertex pair (0-based,
+    // multiplicity defaults to 1). Repeated pairs accumulate. Edges are created in the
+    // same row-major (src, dst) order as for an equivalent adjacency matrix, so both
+    // formats yield identical graphs; no dense matrix is ever allocated.
+    static void parseEdgeList(LineCursor& cursor, int vertexCount, int edgeLines, int graphIndex,
+                              std::vector<Arc>& merged) {
+        std::vector<Arc> arcs;
+        arcs.reserve(edgeLines);
+
+        for (int e = 0; e < edgeLines; ++e) {
+            Span line;
+            if (!cursor.next(line)) {
+                throw Exception("Not enough lines for edge list of graph " +
+                              std::to_string(graphIndex + 1));
             }
 
-            for (int j = 0; j < vertexCount; ++j) {
-                bool ok;
-                int weight = StringUtils::toInt(values[j], &ok);
-                if (!ok) {
-                    throw Exception("Invalid adjacency matrix value '" + values[j] +
-                                  "' at position (" + std::to_string(i + 1) + "," +
-                                  std::to_string(j + 1) + ") in graph " +
-                                  std::to_string(graphIndex + 1));
+            int values[3] = {0, 0, 1};
+            int count = 0;
+            const char* p = line.begin;
+            while (p < line.end) {
+                if (isSpace(*p)) {
+                    ++p;
+                    continue;
                 }
-                if (weight < 0) {
-                    throw Exception("Adjacency matrix value " + std::to_string(weight) +
-                                  " at position (" + std::to_string(i + 1) + "," +
-                                  std::to_string(j + 1) + ") in graph " +
-                                  std::to_string(graphIndex + 1) + " must be non-negative");
+                const char* t = p;
+                while (p < line.end && !isSpace(*p)) ++p;
+
+                if (count < 3) {
+                    int value = 0;
+                    if (parseToken(t, p, value) == TOKEN_INVALID) {
+                        throw Exception("Invalid edge list value '" + std::string(t, p) +
+                                      "' on edge line " + std::to_string(e + 1) +
+                                      " of graph " + std::to_string(graphIndex + 1));
+                    }
+                    values[count] = value;
                 }
-                matrix[i][j] = weight;
+                ++count;
             }
-        }
 
-        // Create directed edges (supports multigraphs and self-loops)
-        for (int i = 0; i < vertexCount; ++i) {
-            for (int j = 0; j < vertexCount; ++j) {
-                int weight = matrix[i][j];
-                for (int w = 0; w < weight; ++w) {
-                    Edge* edge = new Edge();
-                    edge->setOrigin(graph->getVertex(i));
-                    edge->setTarget(graph->getVertex(j));
-                    graph->addEdge(edge);
-
-                    // Connect the edge to vertices (respecting direction)
-                    graph->getVertex(i)->addEdge(edge, Vertex::EDGE_OUT);
-                    graph->getVertex(j)->addEdge(edge, Vertex::EDGE_IN);
+            if (count < 2 || count > 3) {
+                throw Exception("Edge line " + std::to_string(e + 1) +
+                              " of graph " + std::to_string(graphIndex + 1) +
+                              " has " + std::to_string(count) +
+                              " values, expected '<src> <dst> [<multiplicity>]'");
+            }
+            for (int k = 0; k < 2; ++k) {
+                if (values[k] < 0 || values[k] >= vertexCount) {
+                    throw Exception("Edge endpoint " + std::to_string(values[k]) +
+                                  " on edge line " + std::to_string(e + 1) +
+                                  " of graph " + std::to_string(graphIndex + 1) +
+                                  " is out of range [0," + std::to_string(vertexCount - 1) + "]");
                 }
             }
+            if (values[2] < 0) {
+                throw Exception("Edge multiplicity " + std::to_string(values[2]) +
+                              " on edge line " + std::to_string(e + 1) +
+                              " of graph " + std::to_string(graphIndex + 1) +
+                              " must be non-negative");
+            }
+
+            arcs.push_back({values[0], values[1], values[2]});
         }
 
-        return std::make_pair(graph, currentLine + vertexCount);
+        std::sort(arcs.begin(), arcs.end(), [](const Arc& a, const Arc& b) {
+            return a.src != b.src ? a.src < b.src : a.dst < b.dst;
+        });
+
+        // Repeated (src, dst) lines add up; their total must still be a valid multiplicity
+        for (size_t a = 0; a < arcs.size();) {
+            long long weight = 0;
+            size_t b = a;
+            for (; b < arcs.size() && arcs[b].src == arcs[a].src && arcs[b].dst == arcs[a].dst; ++b) {
+                weight += arcs[b].weight;
+            }
+            if (weight > INT_MAX) {
+                throw Exception("Invalid edge list value '" + std::to_string(weight) +
+                              "' (total multiplicity of edge " + std::to_string(arcs[a].src) +
+                              " " + std::to_string(arcs[a].dst) + ") of graph " +
+                              std::to_string(graphIndex + 1));
+            }
+            if (weight > 0) merged.push_back({arcs[a].src, arcs[a].dst, static_cast<int>(weight)});
+            a = b;
+        }
     }
 };
 
@@ -0,0 +1,62 @@
+#ifndef V2_COST_TABLE_H
+#define V2_COST_TABLE_H
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+namespace gempp {
+
+// Substitution costs between query elements (rows) and target elements (columns),
+// stored without a dense matrix.
+//
+// A cost is looked up in this order:
+// 1) a sparse override set with set(),
+// 2) the cost function, if one was installed with setFunction(),
+// 3) the uniform cost (0 unless changed with setUniform()).
+// Memory is proportional to the number of overrides, not to rows x columns.
+class CostTable {
+public:
+    using Function = std::function<double(int, int)>;
+
+    CostTable() : uniform_(0.0) {}
+
+    double get(int i, int j) const {
+        if (!overrides_.empty()) {
+            auto it = overrides_.find(key(i, j));
+            if (it != overrides_.end()) return it->second;
+        }
+        return function_ ? function_(i, j) : uniform_;
+    }
+
+    void set(int i, int j, double value) { overrides_[key(i, j)] = value; }
+
+    // Sets the cost of every pair and drops all overrides and the cost function
+    void setUniform(double value) {
+        uniform_ = value;
+        overrides_.clear();
+        function_ = nullptr;
+    }
+
+    // Computes costs on demand; overrides set afterwards still take precedence
+    void setFunction(Function function) { function_ = std::move(function); }
+
+    // True if every pair has the same cost (getUniform())
+    bool isUniform() const { return overrides_.empty() && !function_; }
+    double getUniform() const { return uniform_; }
+
+    int getOverrideCount() const { return static_cast<int>(overrides_.size()); }
+
+private:
+    static uint64_t key(int i, int j) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(i)) << 32) | static_cast<uint32_t>(j);
+    }
+
+    double uniform_;
+    Function function_;
+    std::unordered_map<uint64_t, double> overrides_;
+};
+
+} // namespace gempp
+
+#endif // V2_COST_TABLE_H
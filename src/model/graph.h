@@ -3,80 +3,69 @@
 
 #include "../core/types.h"
 #include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <string>
 #include <vector>
 
 namespace gempp {
 
-class Edge;
-class Vertex;
-
-// Minimal Vertex class
-class Vertex {
+// Read-only view over a contiguous run of indices
+class IndexSpan {
 public:
-    enum Direction {
-        EDGE_IN = 0,
-        EDGE_OUT,
-        EDGE_IN_OUT
-    };
-
-    Vertex() : index_(-1) {}
-
-    void setIndex(int index) { index_ = index; }
-    int getIndex() const { return index_; }
-
-    void setID(const std::string& id) { id_ = id; }
-    const std::string& getID() const { return id_; }
-
-    void addEdge(Edge* e, Direction d) {
-        edges_[d].push_back(e);
-    }
-
-    void removeEdge(Edge* e) {
-        for (int d = 0; d < 3; ++d) {
-            auto& vec = edges_[d];
-            vec.erase(std::remove(vec.begin(), vec.end(), e), vec.end());
-        }
-    }
-
-    const std::vector<Edge*>& getEdges(Direction d) const {
-        return edges_[d];
-    }
+    IndexSpan(const int* begin, const int* end) : begin_(begin), end_(end) {}
 
-    int getDegree() const {
-        return edges_[EDGE_IN].size() + edges_[EDGE_OUT].size() + edges_[EDGE_IN_OUT].size();
-    }
+    const int* begin() const { return begin_; }
+    const int* end() const { return end_; }
+    int size() const { return static_cast<int>(end_ - begin_); }
+    bool empty() const { return begin_ == end_; }
+    int operator[](int i) const { return begin_[i]; }
 
 private:
-    int index_;
-    std::string id_;
-    std::vector<Edge*> edges_[3]; // IN, OUT, IN_OUT
+    const int* begin_;
+    const int* end_;
 };
 
-// Minimal Edge class
-class Edge {
+// Half-open range of consecutive indices [first, last)
+class IndexRange {
 public:
-    Edge() : origin_(nullptr), target_(nullptr), index_(-1) {}
-
-    void setIndex(int index) { index_ = index; }
-    int getIndex() const { return index_; }
-
-    void setID(const std::string& id) { id_ = id; }
-    const std::string& getID() const { return id_; }
+    class iterator {
+    public:
+        explicit iterator(int v) : v_(v) {}
+        int operator*() const { return v_; }
+        iterator& operator++() { ++v_; return *this; }
+        bool operator!=(const iterator& o) const { return v_ != o.v_; }
+        bool operator==(const iterator& o) const { return v_ == o.v_; }
+
+    private:
+        int v_;
+    };
 
-    void setOrigin(Vertex* v) { origin_ = v; }
-    Vertex* getOrigin() const { return origin_; }
+    IndexRange(int first, int last) : first_(first), last_(last) {}
 
-    void setTarget(Vertex* v) { target_ = v; }
-    Vertex* getTarget() const { return target_; }
+    iterator begin() const { return iterator(first_); }
+    iterator end() const { return iterator(last_); }
+    int size() const { return last_ - first_; }
+    bool empty() const { return first_ == last_; }
 
 private:
-    Vertex* origin_;
-    Vertex* target_;
-    int index_;
-    std::string id_;
+    int first_;
+    int last_;
 };
 
-// Minimal Graph class
+// Immutable multigraph in compressed sparse row (CSR) form.
+//
+// Vertices are 0..n-1 and edges 0..m-1; parallel edges are distinct, consecutive edge
+// indices. Edges are numbered in (origin, target) order, so the outgoing edges of v are
+// the index range [out_offsets_[v], out_offsets_[v+1]) and its out-neighbours are the
+// matching slice of target_. Incoming incidence is a second CSR (in_offsets_, in_edges_)
+// ordered by (target, origin). Graphs are created with Graph::Builder.
+//
+// An edge may also stand for several parallel edges at once (its multiplicity); graphs
+// built that way have one edge per (origin, target) pair instead of one per parallel copy.
+//
+// UNDIRECTED graphs store each edge {u, v} once with origin <= target, so the edges incident
+// to v are getOutEdges(v) together with getInEdges(v) (a self-loop appears in both).
 class Graph {
 public:
     enum Type {
@@ -84,72 +73,196 @@ public:
         UNDIRECTED
     };
 
-    explicit Graph(Type type = DIRECTED) : type_(type) {}
-
-    ~Graph() {
-        for (auto v : vertices_) delete v;
-        for (auto e : edges_) delete e;
-    }
+    class Builder;
 
     // Disable copy
     Graph(const Graph&) = delete;
     Graph& operator=(const Graph&) = delete;
 
-    void setID(const std::string& id) { id_ = id; }
     const std::string& getID() const { return id_; }
 
     Type getType() const { return type_; }
     bool isDirected() const { return type_ == DIRECTED; }
 
-    const std::vector<Vertex*>& getVertices() const { return vertices_; }
-    const std::vector<Edge*>& getEdges() const { return edges_; }
+    int getVertexCount() const { return vertex_count_; }
+    int getEdgeCount() const { return static_cast<int>(target_.size()); }
 
-    Vertex* getVertex(int i) const {
-        if (i >= 0 && i < (int)vertices_.size()) {
-            return vertices_[i];
-        }
-        return nullptr;
+    int getOrigin(int e) const { return origin_[e]; }
+    int getTarget(int e) const { return target_[e]; }
+
+    // Outgoing edge indices of v
+    IndexRange getOutEdges(int v) const {
+        return IndexRange(out_offsets_[v], out_offsets_[v + 1]);
     }
 
-    Vertex* getVertex(const std::string& id) const {
-        auto it = vertex_map_.find(id);
-        if (it != vertex_map_.end()) {
-            return getVertex(it->second);
-        }
-        return nullptr;
+    // Incoming edge indices of v
+    IndexSpan getInEdges(int v) const {
+        return IndexSpan(in_edges_.data() + in_offsets_[v], in_edges_.data() + in_offsets_[v + 1]);
     }
 
-    Edge* getEdge(int i) const {
-        if (i >= 0 && i < (int)edges_.size()) {
-            return edges_[i];
-        }
-        return nullptr;
+    // Targets of the outgoing edges of v (repeated for parallel edges), ascending
+    IndexSpan getOutNeighbors(int v) const {
+        return IndexSpan(target_.data() + out_offsets_[v], target_.data() + out_offsets_[v + 1]);
     }
 
-    void addVertex(Vertex* v, const std::string& id = "") {
-        v->setIndex(vertices_.size());
-        std::string sid = !id.empty() ? id : std::to_string(vertices_.size());
-        if (v->getID().empty()) {
-            v->setID(sid);
-        }
-        vertex_map_[sid] = vertices_.size();
-        vertices_.push_back(v);
+    // Number of parallel edges represented by edge e
+    int getMultiplicity(int e) const { return multiplicity_.empty() ? 1 : multiplicity_[e]; }
+
+    // True if some edge represents more than one parallel edge
+    bool hasMultiplicities() const { return !multiplicity_.empty(); }
+
+    // Edge count with parallel edges counted individually
+    int getTotalMultiplicity() const { return total_multiplicity_; }
+
+    // Number of arcs edge e stands for in the equivalent directed multigraph (a symmetric
+    // adjacency matrix): its multiplicity, doubled for undirected edges other than self-loops
+    int getArcMultiplicity(int e) const {
+        return (type_ == UNDIRECTED && origin_[e] != target_[e]) ? 2 * getMultiplicity(e)
+                                                                 : getMultiplicity(e);
+    }
+
+    // Sum of getArcMultiplicity over all edges
+    int getTotalArcMultiplicity() const { return total_arc_multiplicity_; }
+
+    int getOutDegree(int v) const { return out_offsets_[v + 1] - out_offsets_[v]; }
+    int getInDegree(int v) const { return in_offsets_[v + 1] - in_offsets_[v]; }
+    int getDegree(int v) const { return getOutDegree(v) + getInDegree(v); }
+
+    // Bytes held by the CSR arrays
+    size_t getMemoryUsage() const {
+        return sizeof(Graph) + id_.capacity() +
+               (origin_.capacity() + target_.capacity() + out_offsets_.capacity() +
+                in_offsets_.capacity() + in_edges_.capacity() + multiplicity_.capacity()) * sizeof(int);
+    }
+
+private:
+    Graph(Type type, int vertexCount)
+        : type_(type), vertex_count_(vertexCount), total_multiplicity_(0), total_arc_multiplicity_(0)
+    {}
+
+    Type type_;
+    std::string id_;
+    int vertex_count_;
+    int total_multiplicity_;
+    int total_arc_multiplicity_;
+    std::vector<int> origin_;       // per edge
+    std::vector<int> target_;       // per edge
+    std::vector<int> out_offsets_;  // n + 1
+    std::vector<int> in_offsets_;   // n + 1
+    std::vector<int> in_edges_;     // edge indices grouped by target
+    std::vector<int> multiplicity_; // per edge; empty when every edge is simple
+};
+
+// Collects edges (in any order) and produces an immutable Graph
+class Graph::Builder {
+public:
+    explicit Builder(int vertexCount, Type type = DIRECTED)
+        : type_(type), vertex_count_(vertexCount), sorted_(true), weighted_(false),
+          total_multiplicity_(0), total_arc_multiplicity_(0)
+    {}
+
+    void setID(const std::string& id) { id_ = id; }
+
+    // Adds `multiplicity` parallel edges origin -> target, one edge index each
+    void addEdges(int origin, int target, int multiplicity = 1) {
+        if (!append(origin, target, multiplicity)) return;
+        origin_.insert(origin_.end(), multiplicity, origin);
+        target_.insert(target_.end(), multiplicity, target);
+        if (weighted_) multiplicity_.insert(multiplicity_.end(), multiplicity, 1);
     }
 
-    void addEdge(Edge* e) {
-        e->setIndex(edges_.size());
-        edges_.push_back(e);
+    // Adds a single edge origin -> target standing for `multiplicity` parallel edges
+    void addEdge(int origin, int target, int multiplicity = 1) {
+        if (!append(origin, target, multiplicity)) return;
+        if (multiplicity != 1 && !weighted_) {
+            // Per-edge multiplicities are only stored once some edge needs one
+            multiplicity_.assign(origin_.size(), 1);
+            weighted_ = true;
+        }
+        origin_.push_back(origin);
+        target_.push_back(target);
+        if (weighted_) multiplicity_.push_back(multiplicity);
     }
 
-    int getVertexCount() const { return vertices_.size(); }
-    int getEdgeCount() const { return edges_.size(); }
+    Graph* build() {
+        Graph* g = new Graph(type_, vertex_count_);
+        g->id_ = id_;
+        int m = static_cast<int>(origin_.size());
+
+        if (!sorted_) {
+            std::vector<int> order(m);
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+                return origin_[a] != origin_[b] ? origin_[a] < origin_[b] : target_[a] < target_[b];
+            });
+            g->origin_.resize(m);
+            g->target_.resize(m);
+            if (weighted_) g->multiplicity_.resize(m);
+            for (int e = 0; e < m; ++e) {
+                g->origin_[e] = origin_[order[e]];
+                g->target_[e] = target_[order[e]];
+                if (weighted_) g->multiplicity_[e] = multiplicity_[order[e]];
+            }
+        } else {
+            g->origin_.swap(origin_);
+            g->target_.swap(target_);
+            if (weighted_) g->multiplicity_.swap(multiplicity_);
+        }
+        g->total_multiplicity_ = total_multiplicity_;
+        g->total_arc_multiplicity_ = total_arc_multiplicity_;
+        origin_.clear();
+        target_.clear();
+        multiplicity_.clear();
+        total_multiplicity_ = 0;
+        total_arc_multiplicity_ = 0;
+        sorted_ = true;
+        weighted_ = false;
+
+        // Outgoing CSR: edges are already grouped by origin
+        g->out_offsets_.assign(vertex_count_ + 1, 0);
+        for (int e = 0; e < m; ++e) ++g->out_offsets_[g->origin_[e] + 1];
+        for (int v = 0; v < vertex_count_; ++v) g->out_offsets_[v + 1] += g->out_offsets_[v];
+
+        // Incoming CSR: counting sort by target keeps origins ascending within a bucket
+        g->in_offsets_.assign(vertex_count_ + 1, 0);
+        for (int e = 0; e < m; ++e) ++g->in_offsets_[g->target_[e] + 1];
+        for (int v = 0; v < vertex_count_; ++v) g->in_offsets_[v + 1] += g->in_offsets_[v];
+        g->in_edges_.resize(m);
+        std::vector<int> fill(g->in_offsets_.begin(), g->in_offsets_.end() - 1);
+        for (int e = 0; e < m; ++e) g->in_edges_[fill[g->target_[e]]++] = e;
+
+        return g;
+    }
 
 private:
+    // Validates an edge and tracks ordering; false if there is nothing to add
+    bool append(int origin, int target, int multiplicity) {
+        if (origin < 0 || origin >= vertex_count_ || target < 0 || target >= vertex_count_) {
+            throw Exception("Edge (" + std::to_string(origin) + "," + std::to_string(target) +
+                            ") is out of range for a graph with " +
+                            std::to_string(vertex_count_) + " vertices");
+        }
+        if (multiplicity <= 0) return false;
+        if (!origin_.empty() &&
+            (origin < origin_.back() || (origin == origin_.back() && target < target_.back()))) {
+            sorted_ = false;
+        }
+        total_multiplicity_ += multiplicity;
+        total_arc_multiplicity_ += (type_ == UNDIRECTED && origin != target) ? 2 * multiplicity
+                                                                             : multiplicity;
+        return true;
+    }
+
     Type type_;
     std::string id_;
-    std::vector<Vertex*> vertices_;
-    std::vector<Edge*> edges_;
-    std::unordered_map<std::string, int> vertex_map_;
+    int vertex_count_;
+    bool sorted_;
+    bool weighted_;
+    int total_multiplicity_;
+    int total_arc_multiplicity_;
+    std::vector<int> origin_;
+    std::vector<int> target_;
+    std::vector<int> multiplicity_;
 };
 
 } // namespace gempp
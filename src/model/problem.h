@@ -2,11 +2,14 @@
 #define V2_PROBLEM_H
 
 #include "graph.h"
-#include "../core/matrix.h"
+#include "cost_table.h"
+#include <utility>
 
 namespace gempp {
 
-// Problem class - holds pattern and target graphs with cost matrices
+// Problem class - holds pattern and target graphs with substitution costs.
+// Costs default to a uniform 0 (exact matching) and are never stored densely;
+// see CostTable for overrides and cost functions.
 class Problem {
 public:
     enum Type {
@@ -16,16 +19,7 @@ public:
 
     Problem(Type type, Graph* query, Graph* target)
         : type_(type), query_(query), target_(target)
-    {
-        // Initialize cost matrices with zeros (for exact matching)
-        int nVP = query_->getVertexCount();
-        int nVT = target_->getVertexCount();
-        int nEP = query_->getEdgeCount();
-        int nET = target_->getEdgeCount();
-
-        vCosts_ = Matrix<double>(nVP, nVT, 0.0);
-        eCosts_ = Matrix<double>(nEP, nET, 0.0);
-    }
+    {}
 
     ~Problem() {
         // Don't delete graphs - they're owned by caller
@@ -36,27 +30,32 @@ public:
     Graph* getTarget() const { return target_; }
 
     double getCost(bool isVertex, int queryIndex, int targetIndex) const {
-        if (isVertex) {
-            return vCosts_.getElement(queryIndex, targetIndex);
-        } else {
-            return eCosts_.getElement(queryIndex, targetIndex);
-        }
+        return getCostTable(isVertex).get(queryIndex, targetIndex);
     }
 
     void setCost(bool isVertex, int queryIndex, int targetIndex, double value) {
-        if (isVertex) {
-            vCosts_.setElement(queryIndex, targetIndex, value);
-        } else {
-            eCosts_.setElement(queryIndex, targetIndex, value);
-        }
+        getCostTable(isVertex).set(queryIndex, targetIndex, value);
+    }
+
+    // Same substitution cost for every vertex (or edge) pair
+    void setUniformCost(bool isVertex, double value) {
+        getCostTable(isVertex).setUniform(value);
     }
 
+    // Substitution costs computed on demand from (queryIndex, targetIndex)
+    void setCostFunction(bool isVertex, CostTable::Function function) {
+        getCostTable(isVertex).setFunction(std::move(function));
+    }
+
+    const CostTable& getCostTable(bool isVertex) const { return isVertex ? vCosts_ : eCosts_; }
+    CostTable& getCostTable(bool isVertex) { return isVertex ? vCosts_ : eCosts_; }
+
 private:
     Type type_;
     Graph* query_;   // Pattern graph
     Graph* target_;  // Target graph
-    Matrix<double> vCosts_;  // Vertex substitution costs
-    Matrix<double> eCosts_;  // Edge substitution costs
+    CostTable vCosts_;  // Vertex substitution costs
+    CostTable eCosts_;  // Edge substitution costs
 };
 
 } // namespace gempp
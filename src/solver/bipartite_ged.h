@@ -0,0 +1,254 @@
+#ifndef V2_BIPARTITE_GED_H
+#define V2_BIPARTITE_GED_H
+
+#include "../core/matrix.h"
+#include "../core/types.h"
+#include "../model/graph.h"
+#include "../model/problem.h"
+#include "greedy_solver.h"
+#include "linear_assignment.h"
+#include "matching.h"
+#include "search_common.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace gempp {
+
+// Bipartite graph edit distance approximation (Riesen and Bunke): one LSAP over vertex
+// substitutions, deletions and insertions, priced with the arcs around each vertex, gives both
+// a lower bound and a vertex mapping whose edit path is an upper bound.
+//
+// The (nVP + nVT)^2 cost matrix, with unit edit costs and zero substitution costs as in
+// MCSSolver, out/in counting the arcs to other vertices and loop the self-loop copies:
+// - substitution u -> v: (|out(u) - out(v)| + |in(u) - in(v)|) / 2 + |loop(u) - loop(v)|,
+// - deletion of u (insertion of v): 1 + (out + in) / 2 + loop, on the diagonal of its block,
+// - zero between the dummy rows and columns.
+// Every arc has two end vertices, so charging half of each unmatched arc to each end never
+// exceeds the edit cost of the arcs: the assignment cost is a lower bound (rounded up, edit
+// distances being integers).
+//
+// Rows and columns only depend on the (out, in, loop) signature of their vertex, so the LSAP
+// is solved between signature classes (LinearAssignment::solveGrouped), whose number is small
+// next to the vertices. Vertices of a class are interchangeable for the LSAP but not for the
+// edit path, so the mapping is built in breadth-first order of the pattern: each pattern
+// vertex takes the free target vertex adjacent to the most images of its mapped neighbours
+// (ties to the cheapest substitution), and the vertices without such neighbours follow the
+// class assignment. The mapping is completed into edge matches by GreedySolver::complete, and
+// its edit cost is the upper bound.
+class BipartiteGED {
+public:
+    explicit BipartiteGED(Problem* pb)
+        : pb_(pb), greedy_(pb), nVP_(pb->getQuery()->getVertexCount()),
+          nVT_(pb->getTarget()->getVertexCount())
+    {
+        if (pb->getQuery()->isDirected() != pb->getTarget()->isDirected()) {
+            throw Exception("Pattern and target graphs must be both directed or both undirected");
+        }
+        if (!zeroSubstitutionCosts(pb)) {
+            throw Exception("The bipartite approximation only supports zero substitution costs");
+        }
+        classify(pb->getQuery(), pattern_class_, pattern_signatures_, pattern_neighbours_);
+        classify(pb->getTarget(), target_class_, target_signatures_, target_neighbours_);
+    }
+
+    // Signature classes of the pattern and target vertices (size of the LSAP solved)
+    int getPatternClassCount() const { return static_cast<int>(pattern_signatures_.size()); }
+    int getTargetClassCount() const { return static_cast<int>(target_signatures_.size()); }
+
+    // Edit path of the assignment, with the assignment cost as its bound: optimal if they
+    // meet, feasible otherwise
+    Matching solve() const {
+        int A = getPatternClassCount();
+        int B = getTargetClassCount();
+
+        // Class LSAP: the last row (column) stands for the nVT (nVP) dummy rows (columns)
+        Matrix<double> cost(A + 1, B + 1, 0.0);
+        std::vector<int> rows(A + 1, 0), cols(B + 1, 0);
+        for (int u = 0; u < nVP_; ++u) ++rows[pattern_class_[u]];
+        for (int v = 0; v < nVT_; ++v) ++cols[target_class_[v]];
+        rows[A] = nVT_;
+        cols[B] = nVP_;
+        for (int a = 0; a < A; ++a) {
+            for (int b = 0; b < B; ++b) {
+                cost(a, b) = substitution(pattern_signatures_[a], target_signatures_[b]);
+            }
+            cost(a, B) = removal(pattern_signatures_[a]);
+        }
+        for (int b = 0; b < B; ++b) cost(A, b) = removal(target_signatures_[b]);
+        Matrix<int> flow = LinearAssignment::solveGrouped(cost, rows, cols);
+
+        double assignment = 0.0;
+        for (int a = 0; a <= A; ++a) {
+            for (int b = 0; b <= B; ++b) assignment += flow(a, b) * cost(a, b);
+        }
+
+        Matching result = greedy_.complete(assign(flow, cost));
+
+        // complete() counts the unmatched pattern vertices and arcs; the arcs it matched are
+        // also matched on the target side
+        int mapped = nVP_ - static_cast<int>(result.getUnmatchedPatternVertices().size());
+        long arcsP = pb_->getQuery()->getTotalArcMultiplicity();
+        long arcsT = pb_->getTarget()->getTotalArcMultiplicity();
+        double unmatched_arcs = result.getObjective() - (nVP_ - mapped);
+        double edit_cost = (nVP_ - mapped) + (nVT_ - mapped) + arcsT - arcsP + 2.0 * unmatched_arcs;
+        double bound = std::ceil(assignment - 1e-9);
+
+        result.setObjective(edit_cost);
+        result.setBound(bound);
+        result.setStatus(edit_cost <= bound + 1e-9 ? Matching::OPTIMAL : Matching::FEASIBLE);
+        return result;
+    }
+
+private:
+    // Non-loop arcs leaving and entering a vertex, and its self-loop copies
+    using Signature = std::tuple<int, int, int>;
+
+    static double substitution(const Signature& p, const Signature& t) {
+        return 0.5 * (std::abs(std::get<0>(p) - std::get<0>(t)) +
+                      std::abs(std::get<1>(p) - std::get<1>(t))) +
+               std::abs(std::get<2>(p) - std::get<2>(t));
+    }
+
+    static double removal(const Signature& s) {
+        return 1.0 + 0.5 * (std::get<0>(s) + std::get<1>(s)) + std::get<2>(s);
+    }
+
+    // Signature class of each vertex, the signature of each class, and the neighbours of each
+    // vertex either way
+    static void classify(const Graph* g, std::vector<int>& vertex_class,
+                         std::vector<Signature>& signatures,
+                         std::vector<std::vector<int>>& neighbours) {
+        int n = g->getVertexCount();
+        std::vector<int> out(n, 0), in(n, 0), loops(n, 0);
+        neighbours.assign(n, std::vector<int>());
+        for (int e = 0; e < g->getEdgeCount(); ++e) {
+            int a = g->getOrigin(e);
+            int b = g->getTarget(e);
+            int m = g->getMultiplicity(e);
+            if (a == b) {
+                loops[a] += m;
+                continue;
+            }
+            // An undirected edge is m arcs each way
+            out[a] += m;
+            in[b] += m;
+            if (!g->isDirected()) {
+                out[b] += m;
+                in[a] += m;
+            }
+            neighbours[a].push_back(b);
+            neighbours[b].push_back(a);
+        }
+
+        std::map<Signature, int> index;
+        vertex_class.assign(n, 0);
+        signatures.clear();
+        for (int v = 0; v < n; ++v) {
+            Signature s(out[v], in[v], loops[v]);
+            auto it = index.find(s);
+            if (it == index.end()) {
+                it = index.emplace(s, static_cast<int>(signatures.size())).first;
+                signatures.push_back(s);
+            }
+            vertex_class[v] = it->second;
+        }
+    }
+
+    // Vertex mapping (target vertex of each pattern vertex, -1: deleted) built from the class
+    // assignment flow and the class costs
+    std::vector<int> assign(Matrix<int> flow, const Matrix<double>& cost) const {
+        int B = getTargetClassCount();
+        std::vector<int> mapping(nVP_, -1);
+        std::vector<char> used(nVT_, 0);
+
+        // Target vertices of each class, taken in order when no neighbour fits
+        std::vector<std::vector<int>> members(B);
+        for (int v = 0; v < nVT_; ++v) members[target_class_[v]].push_back(v);
+        std::vector<size_t> next(B, 0);
+
+        // Breadth-first over the pattern, each component from its vertex of highest degree
+        std::vector<int> order;
+        std::vector<char> queued(nVP_, 0);
+        std::vector<int> by_degree(nVP_);
+        for (int u = 0; u < nVP_; ++u) by_degree[u] = u;
+        std::stable_sort(by_degree.begin(), by_degree.end(), [&](int x, int y) {
+            return pattern_neighbours_[x].size() > pattern_neighbours_[y].size();
+        });
+        for (int root : by_degree) {
+            if (queued[root]) continue;
+            queued[root] = 1;
+            order.push_back(root);
+            for (size_t head = order.size() - 1; head < order.size(); ++head) {
+                for (int w : pattern_neighbours_[order[head]]) {
+                    if (!queued[w]) {
+                        queued[w] = 1;
+                        order.push_back(w);
+                    }
+                }
+            }
+        }
+
+        std::vector<int> hits(nVT_, 0);
+        std::vector<int> touched;
+        int any_free = 0;
+        for (int u : order) {
+            int a = pattern_class_[u];
+
+            // Free target vertex around the most images of mapped neighbours, the cheapest
+            // substitution first
+            int chosen = -1;
+            touched.clear();
+            for (int w : pattern_neighbours_[u]) {
+                if (mapping[w] < 0) continue;
+                for (int v : target_neighbours_[mapping[w]]) {
+                    if (used[v]) continue;
+                    if (hits[v]++ == 0) touched.push_back(v);
+                }
+            }
+            for (int v : touched) {
+                if (chosen < 0 || hits[v] > hits[chosen] ||
+                    (hits[v] == hits[chosen] &&
+                     cost(a, target_class_[v]) < cost(a, target_class_[chosen]))) {
+                    chosen = v;
+                }
+            }
+            for (int v : touched) hits[v] = 0;
+
+            // Else the next free vertex of an assigned class, else any free vertex: mapping
+            // a vertex never costs more than deleting it and inserting the target vertex
+            for (int b = 0; b < B && chosen < 0; ++b) {
+                if (flow(a, b) == 0) continue;
+                while (next[b] < members[b].size() && used[members[b][next[b]]]) ++next[b];
+                if (next[b] < members[b].size()) chosen = members[b][next[b]];
+            }
+            while (chosen < 0 && any_free < nVT_) {
+                if (!used[any_free]) chosen = any_free;
+                ++any_free;
+            }
+            if (chosen < 0) continue;
+            mapping[u] = chosen;
+            used[chosen] = 1;
+            int& left = flow(a, target_class_[chosen]);
+            if (left > 0) --left;
+        }
+        return mapping;
+    }
+
+    Problem* pb_;
+    GreedySolver greedy_;
+    int nVP_;
+    int nVT_;
+    std::vector<int> pattern_class_;
+    std::vector<int> target_class_;
+    std::vector<Signature> pattern_signatures_;
+    std::vector<Signature> target_signatures_;
+    std::vector<std::vector<int>> pattern_neighbours_;
+    std::vector<std::vector<int>> target_neighbours_;
+};
+
+} // namespace gempp
+
+#endif // V2_BIPARTITE_GED_H
@@ -0,0 +1,433 @@
+#ifndef V2_BIT_SOLVER_H
+#define V2_BIT_SOLVER_H
+
+#include "../core/bitset.h"
+#include "../core/types.h"
+#include "../model/graph.h"
+#include "../model/problem.h"
+#include "greedy_solver.h"
+#include "linear_assignment.h"
+#include "matching.h"
+#include "search_common.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace gempp {
+
+// Exact minimal extension and graph edit distance for small simple graphs: the branch and
+// bound of MCSSolver (same branching rule, candidate order, bounds and budgets, so the same
+// nodes and objectives) with every vertex set held in a Bitset<Bits>, Bits = 64 or 128 chosen
+// at compile time.
+//
+// Free pattern and target vertices, neighbourhoods and the isolated targets are word sets:
+// mapping i onto k updates the gains only between the free neighbours of i and the free
+// neighbours of k (word ANDs, then one pass over the set bits), and the arcs between free
+// vertices drop by POPCNTs of the same intersections. Gains, free out-arcs and anchors are
+// kept from node to node, along with
+// - the targets of nonzero gain of each pattern vertex (few on sparse graphs), so the bound
+//   reads those gains and settles the other targets, of gain 0, with word tests against
+// - the free targets with at least d arcs towards free targets, for each d.
+// The candidate lists, bound terms and the assignment matrix live in buffers sized once, so
+// the search allocates nothing. The assignment bound also skips the free targets that no
+// free pattern vertex ranks among its best ones (see assignmentBound). None of this changes
+// a bound, so the search explores the nodes of MCSSolver.
+//
+// Only simple graphs fit (at most one arc per ordered pair and one self-loop per vertex, with
+// at most Bits vertices on each side); fits() tells. Multigraphs go to MCSSolver or the ILP.
+template <int Bits>
+class BitParallelSolver : public NativeSearch {
+public:
+    using Set = Bitset<Bits>;
+
+    // True if both graphs of pb are simple, have at most Bits vertices, are both directed or
+    // both undirected, and substitutions cost nothing
+    static bool fits(const Problem* pb) {
+        const Graph* q = pb->getQuery();
+        const Graph* t = pb->getTarget();
+        return q->getVertexCount() <= Bits && t->getVertexCount() <= Bits &&
+               q->isDirected() == t->isDirected() && isSimple(q) && isSimple(t) &&
+               zeroSubstitutionCosts(pb);
+    }
+
+    explicit BitParallelSolver(Problem* pb)
+        : NativeSearch(pb), pb_(pb), greedy_(pb), nVP_(pb->getQuery()->getVertexCount()),
+          nVT_(pb->getTarget()->getVertexCount())
+    {
+        if (!fits(pb)) {
+            throw Exception("The bit-parallel solver needs simple graphs of at most " +
+                            std::to_string(Bits) + " vertices and zero substitution costs");
+        }
+        buildSets(pb->getQuery(), pattern_out_, pattern_in_, pattern_loops_);
+        buildSets(pb->getTarget(), target_out_, target_in_, target_loops_);
+        for (int u = 0; u < nVP_; ++u) {
+            degree_[u] = pattern_loops_.test(u) + pattern_out_[u].count() + pattern_in_[u].count();
+        }
+        for (int v = 0; v < nVT_; ++v) {
+            if (!(target_out_[v] | target_in_[v]).any() && !target_loops_.test(v)) isolated_.set(v);
+        }
+
+        gain_.assign(static_cast<size_t>(nVP_) * Bits, 0);
+        candidates_.assign(static_cast<size_t>(nVP_ + 1) * Bits, 0);
+        cost_.assign(static_cast<size_t>(Bits) * Bits, 0.0);
+        assigned_.assign(nVP_, -1);
+    }
+
+    // Vertex assignment to start from (target vertex of each pattern vertex, -1: unmatched);
+    // the search then only looks for strictly better mappings
+    void setWarmStart(const std::vector<int>& vertex_matching) { warm_start_ = vertex_matching; }
+
+    Matching solve() {
+        startSearch();
+        resetState();
+
+        best_score_ = -1;
+        best_.assign(nVP_, -1);
+        if (!warm_start_.empty()) {
+            best_ = fillMapping(warm_start_, nVT_);
+            best_score_ = scoreOf(best_);
+        }
+        root_bound_ = score_ + bound();
+        if (!closed()) search(0);
+
+        Matching result = greedy_.complete(best_);
+        finish(result, best_score_, root_bound_);
+        return result;
+    }
+
+private:
+    // At most one edge per (origin, target) pair, of multiplicity 1 (parallel edges are
+    // consecutive edge indices)
+    static bool isSimple(const Graph* g) {
+        for (int e = 0; e < g->getEdgeCount(); ++e) {
+            if (g->getMultiplicity(e) != 1) return false;
+            if (e > 0 && g->getOrigin(e) == g->getOrigin(e - 1) &&
+                g->getTarget(e) == g->getTarget(e - 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Out- and in-neighbours of each vertex (both for an undirected edge) and the vertices
+    // with a self-loop
+    static void buildSets(const Graph* g, Set* out, Set* in, Set& loops) {
+        for (int e = 0; e < g->getEdgeCount(); ++e) {
+            int a = g->getOrigin(e);
+            int b = g->getTarget(e);
+            if (a == b) {
+                loops.set(a);
+                continue;
+            }
+            out[a].set(b);
+            in[b].set(a);
+            if (!g->isDirected()) {
+                out[b].set(a);
+                in[a].set(b);
+            }
+        }
+    }
+
+    int& gain(int u, int v) { return gain_[static_cast<size_t>(u) * Bits + v]; }
+
+    // Arcs a vertex assignment matches
+    long scoreOf(const std::vector<int>& mapping) const {
+        long score = 0;
+        for (int i = 0; i < nVP_; ++i) {
+            int k = mapping[i];
+            if (k < 0) continue;
+            score += pattern_loops_.test(i) && target_loops_.test(k);
+            pattern_out_[i].forEach([&](int j) {
+                if (mapping[j] >= 0) score += target_out_[k].test(mapping[j]);
+            });
+        }
+        return score;
+    }
+
+    // Empty mapping
+    void resetState() {
+        free_pattern_ = Set::firstBits(nVP_);
+        free_target_ = Set::firstBits(nVT_);
+        for (int u = 0; u < nVP_; ++u) {
+            bool loop = pattern_loops_.test(u);
+            for (int v = 0; v < nVT_; ++v) gain(u, v) = loop && target_loops_.test(v);
+            gaining_[u] = loop ? target_loops_ : Set();
+            anchored_[u] = 0;
+        }
+        std::fill(assigned_.begin(), assigned_.end(), -1);
+        pattern_inner_ = 0;
+        for (int u = 0; u < nVP_; ++u) {
+            pattern_free_out_[u] = pattern_out_[u].count();
+            pattern_inner_ += pattern_free_out_[u];
+        }
+        target_inner_ = 0;
+        for (int d = 0; d <= Bits; ++d) out_at_least_[d] = Set();
+        for (int v = 0; v < nVT_; ++v) {
+            target_free_out_[v] = target_out_[v].count();
+            target_inner_ += target_free_out_[v];
+            for (int d = 1; d <= target_free_out_[v]; ++d) out_at_least_[d].set(v);
+        }
+        skip_left_ = std::max(0, nVP_ - nVT_);
+        score_ = 0;
+    }
+
+    // Takes pattern vertex i out of (sign 1) or back into (sign -1) the free vertices; the
+    // free set is the one without i either way
+    void removePattern(int i, int sign) {
+        Set in = pattern_in_[i] & free_pattern_;
+        in.forEach([&](int u) { pattern_free_out_[u] -= sign; });
+        pattern_inner_ -= sign * (in.count() + pattern_out_[i].countAnd(free_pattern_));
+    }
+
+    void removeTarget(int k, int sign) {
+        Set in = target_in_[k] & free_target_;
+        in.forEach([&](int v) {
+            if (sign > 0) out_at_least_[target_free_out_[v]].reset(v);
+            target_free_out_[v] -= sign;
+            if (sign < 0) out_at_least_[target_free_out_[v]].set(v);
+        });
+        target_inner_ -= sign * (in.count() + target_out_[k].countAnd(free_target_));
+    }
+
+    // Maps pattern vertex i onto target vertex k (sign 1) or undoes it (sign -1). Only pairs of
+    // free vertices are updated: the others stay taken until this mapping is undone.
+    void map(int i, int k, int sign) {
+        if (sign > 0) {
+            score_ += gain(i, k);
+            assigned_[i] = k;
+            free_pattern_.reset(i);
+            free_target_.reset(k);
+        }
+        removePattern(i, sign);
+        removeTarget(k, sign);
+        // i -> u arcs are matched by k -> v arcs, u -> i arcs by v -> k arcs
+        auto update = [&](int u, const Set& targets) {
+            anchored_[u] += sign;
+            int* row = &gain(u, 0);
+            Set& gaining = gaining_[u];
+            targets.forEach([&](int v) {
+                row[v] += sign;
+                if (row[v] == 0) gaining.reset(v); else gaining.set(v);
+            });
+        };
+        Set target_out = target_out_[k] & free_target_;
+        Set target_in = target_in_[k] & free_target_;
+        (pattern_out_[i] & free_pattern_).forEach([&](int u) { update(u, target_out); });
+        (pattern_in_[i] & free_pattern_).forEach([&](int u) { update(u, target_in); });
+        if (sign < 0) {
+            free_pattern_.set(i);
+            free_target_.set(k);
+            assigned_[i] = -1;
+            score_ -= gain(i, k);
+        }
+    }
+
+    void leaveOut(int i, int sign) {
+        if (sign > 0) free_pattern_.reset(i);
+        removePattern(i, sign);
+        skip_left_ -= sign;
+        if (sign < 0) free_pattern_.set(i);
+    }
+
+    // Upper bound on the arcs the free vertices can still match
+    long bound() {
+        int n = 0;
+        free_pattern_.forEach([&](int u) {
+            const int* row = &gain(u, 0);
+            int out_u = pattern_free_out_[u];
+            int best_gain = 0;
+            int best_total = 0;
+            Set gaining = gaining_[u] & free_target_;
+            gaining.forEach([&](int v) {
+                best_gain = std::max(best_gain, row[v]);
+                best_total = std::max(best_total, row[v] + std::min(out_u, target_free_out_[v]));
+            });
+            // The other free targets add min(out_P(u), out_T(v)) alone
+            Set rest = free_target_ - gaining;
+            for (int d = out_u; d > best_total; --d) {
+                if (out_at_least_[d].intersects(rest)) best_total = d;
+            }
+            best_gain_[n] = best_gain;
+            best_total_[n] = best_total;
+            ++n;
+        });
+        long with_inner = sumDroppingSmallest(best_gain_, n) + std::min(pattern_inner_, target_inner_);
+        return std::min(with_inner, sumDroppingSmallest(best_total_, n));
+    }
+
+    // Sum of the n values without the skip_left_ smallest (the vertices left out match nothing)
+    long sumDroppingSmallest(int* values, int n) const {
+        int drop = std::min(skip_left_, n);
+        if (drop > 0) std::nth_element(values, values + drop, values + n);
+        long sum = 0;
+        for (int r = drop; r < n; ++r) sum += values[r];
+        return sum;
+    }
+
+    // bound() with each free pattern vertex given its own free target vertex: a maximum
+    // weight assignment of gain(u, v) + min(out_P(u), out_T(v)), as in MCSSolver.
+    //
+    // With n pattern vertices, some optimal assignment gives each one a target among its n
+    // best (another one of them is free otherwise), so the other targets are left out of the
+    // matrix when there are more than 2n.
+    long assignmentBound(long cheap) {
+        int n = 0;
+        int m = 0;
+        free_pattern_.forEach([&](int u) { rows_[n++] = u; });
+        free_target_.forEach([&](int v) { cols_[m++] = v; });
+        if (n < 2 || m < 2) return cheap;
+        auto weight = [&](int u, int v) {
+            return gain(u, v) + std::min(pattern_free_out_[u], target_free_out_[v]);
+        };
+
+        if (m > 2 * n) {
+            Set kept;
+            for (int r = 0; r < n; ++r) {
+                int u = rows_[r];
+                for (int c = 0; c < m; ++c) order_[c] = (Bits * 4 - weight(u, cols_[c])) * Bits + c;
+                std::nth_element(order_, order_ + n - 1, order_ + m);
+                for (int c = 0; c < n; ++c) kept.set(cols_[order_[c] % Bits]);
+            }
+            m = 0;
+            kept.forEach([&](int v) { cols_[m++] = v; });
+        }
+
+        // Rows are the smaller side
+        bool transposed = n > m;
+        int rows = transposed ? m : n;
+        int cols = transposed ? n : m;
+        for (int r = 0; r < n; ++r) {
+            for (int c = 0; c < m; ++c) {
+                double w = -weight(rows_[r], cols_[c]);
+                cost_[transposed ? c * cols + r : r * cols + c] = w;
+            }
+        }
+        long total = -std::lround(LinearAssignment::minimumCost(cost_.data(), rows, cols, workspace_));
+        return std::min(cheap, total);
+    }
+
+    // Bound of the current node, the assignment only computed if the cheap bound leaves it
+    // above the incumbent
+    long nodeBound() {
+        long cheap = bound();
+        if (score_ + cheap <= best_score_) return cheap;
+        return assignmentBound(cheap);
+    }
+
+    void recordLeaf() {
+        if (score_ <= best_score_) return;
+        best_score_ = score_;
+        best_ = assigned_;
+    }
+
+    // Free pattern vertex with the most arcs to the mapped ones, then the most arcs
+    int branchVertex() const {
+        int i = -1;
+        free_pattern_.forEach([&](int u) {
+            if (i < 0 || anchored_[u] > anchored_[i] ||
+                (anchored_[u] == anchored_[i] && degree_[u] > degree_[i])) {
+                i = u;
+            }
+        });
+        return i;
+    }
+
+    // Free target vertices for i, by decreasing promise (then by index), in the candidate
+    // buffer of the depth; returns their number
+    int candidates(int i, int depth) {
+        int* list = &candidates_[static_cast<size_t>(depth) * Bits];
+        int count = 0;
+        bool isolated_tried = false;
+        int out_i = pattern_free_out_[i];
+        const int* row = &gain(i, 0);
+        free_target_.forEach([&](int k) {
+            if (isolated_.test(k)) {
+                if (isolated_tried) return;
+                isolated_tried = true;
+            }
+            int promise = row[k] + std::min(out_i, target_free_out_[k]);
+            list[count++] = (Bits * 4 - promise) * Bits + k;
+        });
+        std::sort(list, list + count);
+        for (int c = 0; c < count; ++c) list[c] %= Bits;
+        return count;
+    }
+
+    // Depth-first branch and bound from the current node
+    void search(int depth) {
+        ++node_count_;
+        if (!free_pattern_.any()) {
+            recordLeaf();
+            return;
+        }
+        if (score_ + nodeBound() <= best_score_ || closed() || outOfBudget()) return;
+
+        int i = branchVertex();
+        int count = candidates(i, depth);
+        const int* list = &candidates_[static_cast<size_t>(depth) * Bits];
+        for (int c = 0; c < count; ++c) {
+            int k = list[c];
+            map(i, k, 1);
+            search(depth + 1);
+            map(i, k, -1);
+            if (closed() || stopped_) return;
+        }
+        if (skip_left_ > 0) {
+            leaveOut(i, 1);
+            search(depth + 1);
+            leaveOut(i, -1);
+        }
+    }
+
+    // Depth-first only: the bound of the search stays the root bound
+    bool closed() { return NativeSearch::closed(best_score_, root_bound_); }
+
+    bool outOfBudget() { return NativeSearch::outOfBudget(best_score_); }
+
+    Problem* pb_;
+    GreedySolver greedy_;
+    int nVP_;
+    int nVT_;
+    Set pattern_out_[Bits];
+    Set pattern_in_[Bits];
+    Set target_out_[Bits];
+    Set target_in_[Bits];
+    Set pattern_loops_;
+    Set target_loops_;
+    Set isolated_;  // target vertices without any arc
+    int degree_[Bits] = {};  // arcs of each pattern vertex, self-loop included
+
+    // Search state, kept from node to node
+    Set free_pattern_;  // neither mapped nor left out
+    Set free_target_;
+    std::vector<int> gain_;  // nVP x Bits: arcs u -> v would match with the mapped pairs
+    Set gaining_[Bits];  // targets v of nonzero gain(u, v), for each pattern vertex u
+    Set out_at_least_[Bits + 1];  // targets with at least d arcs towards free targets
+    int anchored_[Bits] = {};  // arcs to the mapped pattern vertices
+    int pattern_free_out_[Bits] = {};  // arcs towards free vertices
+    int target_free_out_[Bits] = {};
+    long pattern_inner_ = 0;  // arcs between free vertices
+    long target_inner_ = 0;
+    std::vector<int> assigned_;
+    int skip_left_ = 0;
+    long score_ = 0;
+
+    // Buffers of the nodes
+    std::vector<int> candidates_;  // (nVP + 1) x Bits, one list per depth
+    int best_gain_[Bits] = {};
+    int best_total_[Bits] = {};
+    int rows_[Bits] = {};
+    int cols_[Bits] = {};
+    int order_[Bits] = {};
+    std::vector<double> cost_;  // Bits x Bits
+    LinearAssignment::Workspace workspace_;
+
+    long best_score_ = -1;
+    std::vector<int> best_;
+    long root_bound_ = 0;
+    std::vector<int> warm_start_;
+};
+
+} // namespace gempp
+
+#endif // V2_BIT_SOLVER_H
@@ -2,13 +2,29 @@
 #define V2_GLPK_SOLVER_H
 
 #include "../integer_programming/linear_program.h"
+#include "matching.h"
 #include "../core/types.h"
 #include <glpk.h>
-#include <unordered_map>
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
 
 namespace gempp {
 
-class GLPKSolver {
+// GLPK backend. The model is either loaded from a LinearProgram by init(), or streamed in:
+// pass the solver as the LinearProgram's RowSink (formulation init) and every constraint
+// goes straight into the GLPK problem as it is closed, so the matrix is held only once.
+// init() then adds the column kinds and bounds, the objective and any stored rows.
+//
+// Only active variables become GLPK columns: a variable that is inactive (fixed to zero) when
+// its columns are mapped is left out of the model, and reads back as 0 in the solution.
+class GLPKSolver : public RowSink {
 public:
     enum Status {
         OPTIMAL,
@@ -18,62 +34,239 @@ public:
         NOT_SOLVED
     };
 
-    GLPKSolver() : model_(nullptr), first_feasible_(false) {}
+    GLPKSolver() : lp_(nullptr), model_(nullptr), first_feasible_(false), status_(NOT_SOLVED) {}
 
-    ~GLPKSolver() {
+    ~GLPKSolver() override {
         if (model_) {
             glp_delete_prob(model_);
             glp_free_env();
         }
     }
 
-    // Callback to terminate after first feasible integer solution
-    static void firstFeasibleCallback(glp_tree* tree, void* info) {
+    // Primal heuristic for the branch-and-bound nodes: maps the LP values of a node (one per
+    // variable, NaN for variables left out of the model) to an integer point (one value per
+    // variable; empty: none)
+    using Rounding = std::function<std::vector<double>(const std::vector<double>&)>;
+
+    // Lazy constraints: appends to the store the rows violated by the LP values of a node (one
+    // per variable, NaN for variables left out of the model)
+    using Separator = std::function<void(const std::vector<double>&, ConstraintStore&)>;
+
+    // Branch-and-bound callback: counts nodes, tracks the global bound, notes the time of the
+    // first incumbent, adds violated lazy rows, offers the warm start to the first heuristic call
+    // and the rounding to every one, and terminates once the incumbent reaches the lower bound
+    // (proven optimal), in first-feasible mode after the first integer feasible solution, and
+    // on the node limit or a stop request
+    static void branchAndBoundCallback(glp_tree* tree, void* info) {
         GLPKSolver* solver = static_cast<GLPKSolver*>(info);
-        if (solver && solver->first_feasible_) {
-            int reason = glp_ios_reason(tree);
-            if (reason == GLP_IBINGO) {
-                // Found an integer feasible solution - terminate immediately
-                glp_ios_terminate(tree);
-            }
+        glp_ios_tree_size(tree, nullptr, nullptr, &solver->node_count_);
+        int best = glp_ios_best_node(tree);
+        if (best != 0) solver->tree_bound_ = glp_ios_node_bound(tree, best);
+        switch (glp_ios_reason(tree)) {
+            case GLP_IROWGEN:
+                // Rows added at a node are kept for its subtree
+                if (solver->original_columns_ && solver->separator_) solver->separateModel();
+                break;
+            case GLP_IHEUR:
+                if (!solver->original_columns_) break;
+                if (!solver->warm_start_.empty() && !solver->warm_start_offered_) {
+                    solver->warm_start_offered_ = true;
+                    glp_ios_heur_sol(tree, solver->warm_start_.data());
+                }
+                if (solver->rounding_) solver->roundNode(tree);
+                break;
+            case GLP_IBINGO:
+                if (solver->first_feasible_) glp_ios_terminate(tree);
+                break;
+            default:
+                break;
+        }
+        glp_prob* prob = glp_ios_get_prob(tree);
+        if (glp_mip_status(prob) == GLP_FEAS && solver->first_incumbent_ms_ < 0.0) {
+            solver->first_incumbent_ms_ = solver->elapsedMs();
+        }
+        if (glp_mip_status(prob) == GLP_FEAS && solver->meetsLowerBound(glp_mip_obj_val(prob))) {
+            solver->bound_met_ = true;
+            glp_ios_terminate(tree);
+        } else if ((solver->node_limit_ > 0 && solver->node_count_ >= solver->node_limit_) ||
+                   (solver->stop_flag_ && *solver->stop_flag_) || solver->gapReached(tree)) {
+            glp_ios_terminate(tree);
         }
     }
 
     void init(LinearProgram* lp, bool verbose = false, bool relaxed = false,
               bool first_feasible = false) {
-        if (model_) {
-            glp_delete_prob(model_);
-        }
+        // Keeps the rows streamed in through addRow()
+        if (!model_) createModel();
 
         lp_ = lp;
-        model_ = glp_create_prob();
-        glp_set_prob_name(model_, "gempp");
-        relaxed_ = relaxed;
-        first_feasible_ = first_feasible;
+        configure(verbose, relaxed, first_feasible);
+        buildModel();
+    }
 
-        glp_init_iocp(&config_);
-        config_.msg_lev = verbose ? GLP_MSG_ALL : GLP_MSG_OFF;
-        config_.tm_lim = INT_MAX;
-        config_.mip_gap = 1e-9;
-        config_.presolve = GLP_ON;
+    // Loads a model written by writeModel() instead of building one. columnCount is the
+    // number of variables of the formulation and column(name) gives the variable of a column
+    // name (-1 if unknown); MPS does not record the objective sense, so it is given too.
+    // Returns false if the file cannot be read.
+    bool readModel(const std::string& path, LinearProgram::Sense sense, int columnCount,
+                   const std::function<int(const std::string&)>& column, bool verbose = false,
+                   bool relaxed = false, bool first_feasible = false) {
+        if (model_) glp_delete_prob(model_);
+        createModel();
+        lp_ = nullptr;
+        configure(verbose, relaxed, first_feasible);
+
+        int previous = glp_term_out(verbose ? GLP_ON : GLP_OFF);
+        bool isLp = hasSuffix(path, ".lp");
+        int ret = isLp ? glp_read_lp(model_, nullptr, path.c_str())
+                       : glp_read_mps(model_, GLP_MPS_FILE, nullptr, path.c_str());
+        glp_term_out(previous);
+        if (ret != 0) {
+            glp_erase_prob(model_);
+            return false;
+        }
+        glp_set_obj_dir(model_, sense == LinearProgram::MAXIMIZE ? GLP_MAX : GLP_MIN);
+
+        column_count_ = columnCount;
+        glp_col_.assign(columnCount, 0);
+        for (int j = 1; j <= glp_get_num_cols(model_); ++j) {
+            const char* name = glp_get_col_name(model_, j);
+            int col = name ? column(name) : -1;
+            if (col < 0 || col >= columnCount) {
+                throw Exception("Model file '" + path + "' has unknown column '" +
+                                (name ? name : "") + "'");
+            }
+            glp_col_[col] = j;
+        }
+        return true;
+    }
+
+    // Offers values (one per variable, as in solve()) to branch and bound as its first
+    // incumbent, so that nodes are pruned against it from the root. Returns false, and offers
+    // nothing, if the model is relaxed or the values are not an integer feasible point of it.
+    bool setWarmStart(const std::vector<double>& values) {
+        warm_start_.clear();
+        if (!model_ || relaxed_) return false;
+        saveBounds();
+        std::vector<double> x;
+        if (!toFeasiblePoint(values, x)) return false;
+        warm_start_ = std::move(x);
+        return true;
+    }
 
-        // Set up callback for first-feasible mode
-        if (first_feasible_ && !relaxed_) {
-            config_.cb_func = firstFeasibleCallback;
-            config_.cb_info = this;
-            // Keep presolve enabled - it helps find solutions faster
+    // Runs rounding at every branch-and-bound node and hands its point to GLPK when it is
+    // feasible and improves on the incumbent (nullptr: none). As with a warm start, the root
+    // relaxation is then solved without the MIP presolver, whose columns the point would not
+    // match.
+    void setRounding(Rounding rounding) { rounding_ = std::move(rounding); }
+
+    // Adds the rows separator finds violated at each LP solution, until there are none: in an
+    // integer solve at every branch-and-bound node (GLP_IROWGEN), in a relaxation by re-solving.
+    // For models built without some of their rows; set it before setWarmStart, which also
+    // checks the warm start against it. Disables the MIP presolver, like a warm start.
+    void setSeparator(Separator separator) { separator_ = std::move(separator); }
+
+    // Proven lower bound on the optimum (see LowerBounds): an integer solve stops as soon as
+    // its incumbent reaches it, and reports the incumbent as optimal. Minimization only.
+    void setLowerBound(double bound) { lower_bound_ = bound; }
+    double getLowerBound() const { return lower_bound_; }
+
+    // True if the last integer solve was closed by the lower bound
+    bool isBoundMet() const { return bound_met_; }
+
+    // Budgets of an integer solve; when one runs out the best incumbent is returned as a
+    // feasible (not optimal) solution together with the global bound (getBound()).
+    // Wall-clock limit in seconds (<= 0: none)
+    void setTimeLimit(double seconds) {
+        time_limit_ms_ = (seconds > 0.0 && seconds * 1000.0 < INT_MAX)
+                             ? static_cast<int>(std::ceil(seconds * 1000.0)) : INT_MAX;
+    }
+    // Branch-and-bound node limit (0: none)
+    void setNodeLimit(int nodes) { node_limit_ = nodes; }
+    // Relative gap (incumbent - bound) / |incumbent| at which the search stops (default 1e-9)
+    void setMipGap(double gap) { mip_gap_ = gap; }
+
+    // The search stops at its next callback once *flag becomes non-zero (e.g. set by a
+    // SIGINT handler); nullptr: none
+    void setStopFlag(const volatile std::sig_atomic_t* flag) { stop_flag_ = flag; }
+
+    // Proven lower bound on the optimum after the last solve: the objective if it was solved
+    // to optimality, else the best of the branch-and-bound global bound and setLowerBound()
+    double getBound() const { return bound_; }
+
+    // Branch-and-bound nodes created by the last integer solve (0 for a relaxation)
+    int getNodeCount() const { return node_count_; }
+
+    // Milliseconds from the start of the last integer solve to its first incumbent (warm
+    // start included), negative if it found none
+    double getFirstIncumbentTime() const { return first_incumbent_ms_; }
+
+    // Nodes of the last integer solve where the rounding ran / improved the incumbent
+    int getRoundingCount() const { return rounding_calls_; }
+    int getRoundingImprovements() const { return rounding_improvements_; }
+
+    // Rows added by the separator during the last solve, and the separations that added any
+    int getLazyRowCount() const { return lazy_rows_; }
+    int getLazyRounds() const { return lazy_rounds_; }
+
+    // Writes the GLPK model, as CPLEX LP if path ends in ".lp" and as free MPS otherwise.
+    // Columns are named after their variables (VariableStore::getName).
+    void writeModel(const std::string& path) {
+        if (!model_) {
+            throw Exception("GLPK solver must be initialized before writing the model");
+        }
+        if (lp_) {
+            const VariableStore& vars = lp_->getVariables();
+            for (int col = 0; col < static_cast<int>(glp_col_.size()); ++col) {
+                if (glp_col_[col] > 0) glp_set_col_name(model_, glp_col_[col], vars.getName(col).c_str());
+            }
         }
 
-        buildModel();
+        int previous = glp_term_out(GLP_OFF);
+        int ret = hasSuffix(path, ".lp") ? glp_write_lp(model_, nullptr, path.c_str())
+                                         : glp_write_mps(model_, GLP_MPS_FILE, nullptr, path.c_str());
+        glp_term_out(previous);
+        if (ret != 0) {
+            throw Exception("Cannot write model file '" + path + "'");
+        }
     }
 
-    double solve(std::unordered_map<std::string, double>& solution) {
+    // RowSink: appends the row to the GLPK problem (GLPK row = constraint index + 1)
+    void addRow(const VariableStore& vars, const int* cols, const double* coefs, int size,
+                ConstraintStore::Relation relation, double rhs) override {
+        if (!model_) createModel();
+        mapColumns(vars);
+
+        int idx = glp_add_rows(model_, 1);
+        setRowBounds(idx, relation, rhs);
+        setRow(idx, cols, coefs, size);
+    }
+
+    // Size of the GLPK model (after compaction)
+    int getRowCount() const { return model_ ? glp_get_num_rows(model_) : 0; }
+    int getColumnCount() const { return model_ ? glp_get_num_cols(model_) : 0; }
+    int getNonZeroCount() const { return model_ ? glp_get_num_nz(model_) : 0; }
+
+    // Solves the model; solution[col] receives the value of column col
+    double solve(std::vector<double>& solution) {
         if (!model_) {
             throw Exception("GLPK solver must be initialized before solving");
         }
 
-        Status status = NOT_SOLVED;
-        double obj = (lp_->getSense() == LinearProgram::MINIMIZE) ? INFINITY : -INFINITY;
+        status_ = NOT_SOLVED;
+        node_count_ = 0;
+        bound_met_ = false;
+        tree_bound_ = -INFINITY;
+        first_incumbent_ms_ = -1.0;
+        rounding_calls_ = 0;
+        rounding_improvements_ = 0;
+        lazy_rows_ = 0;
+        lazy_rounds_ = 0;
+        original_columns_ = false;
+        solve_start_ = std::chrono::steady_clock::now();
+        config_.tm_lim = time_limit_ms_;
+        config_.mip_gap = mip_gap_;
+        double obj = (glp_get_obj_dir(model_) == GLP_MIN) ? INFINITY : -INFINITY;
 
         if (relaxed_) {
             glp_smcp smcp;
@@ -81,132 +274,441 @@ public:
             smcp.msg_lev = config_.msg_lev;
             smcp.tm_lim = config_.tm_lim;
 
-            if (!glp_simplex(model_, &smcp)) {
+            // With a separator: re-solve (dual simplex from the last basis) until no row is
+            // violated
+            bool solved = glp_simplex(model_, &smcp) == 0;
+            while (solved && separator_ && glp_get_status(model_) == GLP_OPT &&
+                   separateModel() > 0) {
+                smcp.meth = GLP_DUALP;
+                if (time_limit_ms_ != INT_MAX) {
+                    smcp.tm_lim = std::max(1, time_limit_ms_ - static_cast<int>(elapsedMs()));
+                }
+                solved = glp_simplex(model_, &smcp) == 0;
+            }
+            if (solved) {
                 switch (glp_get_status(model_)) {
                     case GLP_OPT:
-                        status = OPTIMAL;
+                        status_ = OPTIMAL;
                         break;
                     case GLP_FEAS:
-                        status = SUBOPTIMAL;
+                        status_ = SUBOPTIMAL;
                         break;
                     case GLP_INFEAS:
-                        status = INFEASIBLE;
+                        status_ = INFEASIBLE;
                         break;
                     case GLP_UNBND:
-                        status = UNBOUNDED;
+                        status_ = UNBOUNDED;
                         break;
                     default:
-                        status = NOT_SOLVED;
+                        status_ = NOT_SOLVED;
                         break;
                 }
             }
-            if (status == OPTIMAL || status == SUBOPTIMAL) {
+            if (status_ == OPTIMAL || status_ == SUBOPTIMAL) {
                 obj = glp_get_obj_val(model_);
-                for (const auto& pair : var_order_) {
-                    const std::string& var_id = pair.first;
-                    int col_idx = pair.second;
-                    double value = glp_get_col_prim(model_, col_idx);
-                    solution[var_id] = value;
+                solution.assign(column_count_, 0.0);
+                for (int col = 0; col < column_count_; ++col) {
+                    if (glp_col_[col] > 0) solution[col] = glp_get_col_prim(model_, glp_col_[col]);
                 }
             }
+        } else if (!warm_start_.empty() && meetsLowerBound(warmStartObjective())) {
+            // The warm start already reaches the lower bound: it is optimal, nothing to search
+            bound_met_ = true;
+            status_ = OPTIMAL;
+            first_incumbent_ms_ = 0.0;
+            obj = warmStartObjective();
+            warmStartSolution(solution);
         } else {
-            int ret = glp_intopt(model_, &config_);
-            // Handle both normal completion (ret==0) and early termination (GLP_ESTOP)
-            if (ret == 0 || ret == GLP_ESTOP) {
+            // glp_ios_heur_sol takes values for the columns of the problem being searched, which
+            // the MIP presolver replaces by its own: with a warm start or a rounding, solve the
+            // root relaxation here and search the model as it is
+            warm_start_offered_ = false;
+            int ret = 0;
+            if (!warm_start_.empty() || rounding_ || separator_) {
+                saveBounds();
+                glp_smcp smcp;
+                glp_init_smcp(&smcp);
+                smcp.msg_lev = config_.msg_lev;
+                smcp.tm_lim = config_.tm_lim;
+                ret = glp_simplex(model_, &smcp);
+                original_columns_ = ret == 0 && glp_get_status(model_) == GLP_OPT;
+                if (time_limit_ms_ != INT_MAX) {
+                    config_.tm_lim = std::max(1, time_limit_ms_ - static_cast<int>(elapsedMs()));
+                }
+            }
+            // No search if the time ran out in the root relaxation. Lazy rows need the model's
+            // columns too: without them there is no valid search (GLP_EROOT)
+            if (ret != GLP_ETMLIM) {
+                config_.presolve = (original_columns_ || separator_) ? GLP_OFF : GLP_ON;
+                // GLPK's rounding heuristic only sees the rows added so far
+                config_.sr_heur = separator_ ? GLP_OFF : GLP_ON;
+                ret = glp_intopt(model_, &config_);
+            }
+            // Normal completion (ret==0) and early termination: callback (GLP_ESTOP), time
+            // limit and gap target; the last three may leave a feasible incumbent
+            if (ret == 0 || ret == GLP_ESTOP || ret == GLP_ETMLIM || ret == GLP_EMIPGAP) {
                 switch (glp_mip_status(model_)) {
                     case GLP_OPT:
-                        status = OPTIMAL;
+                        status_ = OPTIMAL;
                         break;
                     case GLP_FEAS:
-                        status = SUBOPTIMAL;
+                        status_ = bound_met_ ? OPTIMAL : SUBOPTIMAL;
                         break;
                     case GLP_NOFEAS:
-                        status = INFEASIBLE;
+                        status_ = INFEASIBLE;
                         break;
                     case GLP_UNDEF:
-                        status = NOT_SOLVED;
+                        status_ = NOT_SOLVED;
                         break;
                 }
             }
 
-            if (status == OPTIMAL || status == SUBOPTIMAL) {
+            if (status_ == OPTIMAL || status_ == SUBOPTIMAL) {
                 obj = glp_mip_obj_val(model_);
 
                 // Extract solution
-                for (const auto& pair : var_order_) {
-                    const std::string& var_id = pair.first;
-                    int col_idx = pair.second;
-                    double value = glp_mip_col_val(model_, col_idx);
-                    solution[var_id] = value;
+                solution.assign(column_count_, 0.0);
+                for (int col = 0; col < column_count_; ++col) {
+                    if (glp_col_[col] > 0) solution[col] = glp_mip_col_val(model_, glp_col_[col]);
                 }
+            } else if (status_ == NOT_SOLVED && !warm_start_.empty()) {
+                // Stopped before the search took the warm start: it is the best solution known
+                status_ = SUBOPTIMAL;
+                obj = warmStartObjective();
+                warmStartSolution(solution);
             }
         }
 
+        // Costs offset by a constant: snap rounding noise around 0 so it does not print as "-0"
+        if (std::abs(obj) < 1e-9) obj = 0.0;
+        if (status_ != OPTIMAL) {
+            bound_ = std::max(lower_bound_, tree_bound_);
+            if (std::abs(bound_) < 1e-9) bound_ = 0.0;
+            // Stopped with the incumbent at the bound (e.g. by the gap test): proven optimal
+            if (status_ == SUBOPTIMAL && obj - bound_ <= 1e-6) status_ = OPTIMAL;
+        }
+        if (status_ == OPTIMAL) bound_ = obj;
         return obj;
     }
 
+    // Solves a MatchingLayout formulation of pb and reads the matching off its columns
+    Matching solve(const Problem* pb) {
+        std::vector<double> values;
+        double obj = solve(values);
+        Matching matching = Matching::fromColumns(pb, values);
+        matching.setObjective(obj);
+        matching.setBound(bound_);
+        switch (status_) {
+            case OPTIMAL:
+                matching.setStatus(Matching::OPTIMAL);
+                break;
+            case SUBOPTIMAL:
+                matching.setStatus(Matching::FEASIBLE);
+                break;
+            case INFEASIBLE:
+                matching.setStatus(Matching::INFEASIBLE);
+                break;
+            case UNBOUNDED:
+                matching.setStatus(Matching::UNBOUNDED);
+                break;
+            case NOT_SOLVED:
+                matching.setStatus(Matching::NOT_SOLVED);
+                break;
+        }
+        return matching;
+    }
+
+    // Status of the last solve()
+    Status getStatus() const { return status_; }
+
 private:
+    void configure(bool verbose, bool relaxed, bool first_feasible) {
+        relaxed_ = relaxed;
+        first_feasible_ = first_feasible;
+
+        glp_init_iocp(&config_);
+        config_.msg_lev = verbose ? GLP_MSG_ALL : GLP_MSG_OFF;
+        config_.tm_lim = time_limit_ms_;
+        config_.mip_gap = mip_gap_;
+        config_.presolve = GLP_ON;
+
+        // Node counting, warm start and first-feasible mode (which keeps presolve enabled:
+        // it helps find solutions faster)
+        config_.cb_func = branchAndBoundCallback;
+        config_.cb_info = this;
+    }
+
+    // Gap target reached against the best of GLPK's bound and the external lower bound (GLPK
+    // only checks its own)
+    bool gapReached(glp_tree* tree) const {
+        glp_prob* prob = glp_ios_get_prob(tree);
+        if (glp_get_obj_dir(model_) != GLP_MIN || glp_mip_status(prob) != GLP_FEAS) return false;
+        double incumbent = glp_mip_obj_val(prob);
+        double bound = std::max(lower_bound_, tree_bound_);
+        return incumbent - bound <= mip_gap_ * (std::abs(incumbent) + DBL_EPSILON);
+    }
+
+    // LP values of the model (or current node) per variable, NaN for left-out variables
+    void readNodeValues() {
+        node_values_.assign(column_count_, NAN);
+        for (int col = 0; col < column_count_; ++col) {
+            if (glp_col_[col] > 0) node_values_[col] = glp_get_col_prim(model_, glp_col_[col]);
+        }
+    }
+
+    // Adds the rows the separator finds violated by the current LP solution; returns how many
+    int separateModel() {
+        readNodeValues();
+        ConstraintStore rows;
+        separator_(node_values_, rows);
+        for (int r = 0; r < rows.getStoredRowCount(); ++r) {
+            // Terms on left-out (fixed to zero) variables are dropped
+            int size = 0;
+            if (static_cast<int>(row_ind_.size()) < rows.getRowSize(r) + 1) {
+                row_ind_.resize(rows.getRowSize(r) + 1);
+                row_val_.resize(rows.getRowSize(r) + 1);
+            }
+            for (int t = 0; t < rows.getRowSize(r); ++t) {
+                int j = glp_col_[rows.getColumns(r)[t]];
+                if (j == 0) continue;
+                ++size;
+                row_ind_[size] = j;
+                row_val_[size] = rows.getCoefficients(r)[t];
+            }
+            int idx = glp_add_rows(model_, 1);
+            setRowBounds(idx, rows.getRelation(r), rows.getRHS(r));
+            glp_set_mat_row(model_, idx, size, row_ind_.data(), row_val_.data());
+        }
+        lazy_rows_ += rows.getStoredRowCount();
+        if (rows.getStoredRowCount() > 0) ++lazy_rounds_;
+        return rows.getStoredRowCount();
+    }
+
+    // Rounds the LP solution of the current node and offers the point to GLPK
+    void roundNode(glp_tree* tree) {
+        ++rounding_calls_;
+        readNodeValues();
+        std::vector<double> values = rounding_(node_values_);
+        std::vector<double> point;
+        if (improvesIncumbent(values) && toFeasiblePoint(values, point) &&
+            glp_ios_heur_sol(tree, point.data()) == 0) {
+            ++rounding_improvements_;
+        }
+    }
+
+    // Objective of values (one per variable) better than the incumbent's, if any; checked
+    // before the (costlier) feasibility test
+    bool improvesIncumbent(const std::vector<double>& values) const {
+        if (glp_mip_status(model_) != GLP_FEAS) return true;
+        double obj = glp_get_obj_coef(model_, 0);
+        for (int col = 0; col < static_cast<int>(values.size()) && col < column_count_; ++col) {
+            if (glp_col_[col] > 0) obj += glp_get_obj_coef(model_, glp_col_[col]) * values[col];
+        }
+        double incumbent = glp_mip_obj_val(model_);
+        return glp_get_obj_dir(model_) == GLP_MIN ? obj < incumbent - 1e-9 : obj > incumbent + 1e-9;
+    }
+
+    // Global column and row bounds: branch and bound changes those of the model at each node
+    void saveBounds() {
+        int n = glp_get_num_cols(model_);
+        int m = glp_get_num_rows(model_);
+        col_bounds_.resize(n + 1);
+        row_bounds_.resize(m + 1);
+        for (int j = 1; j <= n; ++j) {
+            col_bounds_[j] = {glp_get_col_type(model_, j), glp_get_col_lb(model_, j),
+                              glp_get_col_ub(model_, j)};
+        }
+        for (int i = 1; i <= m; ++i) {
+            row_bounds_[i] = {glp_get_row_type(model_, i), glp_get_row_lb(model_, i),
+                              glp_get_row_ub(model_, i)};
+        }
+    }
+
+    // 1-based GLPK column values x of values (one per variable) if they are an integer
+    // feasible point of the model, within the bounds of saveBounds()
+    bool toFeasiblePoint(const std::vector<double>& values, std::vector<double>& x) {
+        if (static_cast<int>(values.size()) != column_count_) return false;
+
+        const double eps = 1e-9;
+        int n = glp_get_num_cols(model_);
+        x.assign(n + 1, 0.0);
+        for (int col = 0; col < column_count_; ++col) {
+            if (glp_col_[col] > 0) {
+                x[glp_col_[col]] = values[col];
+            } else if (values[col] != 0.0) {
+                return false;  // left out of the model: fixed to zero
+            }
+        }
+        for (int j = 1; j <= n; ++j) {
+            if (glp_get_col_kind(model_, j) != GLP_CV && x[j] != std::floor(x[j])) return false;
+            if (!withinBounds(col_bounds_[j], x[j], eps)) return false;
+        }
+        if (static_cast<int>(row_ind_.size()) < n + 1) {
+            row_ind_.resize(n + 1);
+            row_val_.resize(n + 1);
+        }
+        // Rows of the model as built (cuts added by the search come after them)
+        for (int i = 1; i < static_cast<int>(row_bounds_.size()); ++i) {
+            int len = glp_get_mat_row(model_, i, row_ind_.data(), row_val_.data());
+            double activity = 0.0;
+            for (int t = 1; t <= len; ++t) activity += row_val_[t] * x[row_ind_[t]];
+            if (!withinBounds(row_bounds_[i], activity, eps)) return false;
+        }
+        if (separator_) {
+            ConstraintStore violated;
+            separator_(values, violated);
+            if (violated.getStoredRowCount() > 0) return false;
+        }
+        return true;
+    }
+
+    double elapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                         solve_start_).count();
+    }
+
+    bool meetsLowerBound(double objective) const {
+        return glp_get_obj_dir(model_) == GLP_MIN && objective <= lower_bound_ + 1e-6;
+    }
+
+    void warmStartSolution(std::vector<double>& solution) const {
+        solution.assign(column_count_, 0.0);
+        for (int col = 0; col < column_count_; ++col) {
+            if (glp_col_[col] > 0) solution[col] = warm_start_[glp_col_[col]];
+        }
+    }
+
+    double warmStartObjective() const {
+        double obj = glp_get_obj_coef(model_, 0);
+        for (int j = 1; j < static_cast<int>(warm_start_.size()); ++j) {
+            obj += glp_get_obj_coef(model_, j) * warm_start_[j];
+        }
+        return obj;
+    }
+
+    // GLPK bounds of a row or column
+    struct Bounds {
+        int type;
+        double lb;
+        double ub;
+    };
+
+    static bool withinBounds(const Bounds& bounds, double value, double eps) {
+        bool lower = bounds.type == GLP_LO || bounds.type == GLP_DB || bounds.type == GLP_FX;
+        bool upper = bounds.type == GLP_UP || bounds.type == GLP_DB || bounds.type == GLP_FX;
+        return !(lower && value < bounds.lb - eps) && !(upper && value > bounds.ub + eps);
+    }
+
+    static bool hasSuffix(const std::string& s, const std::string& suffix) {
+        return s.size() >= suffix.size() &&
+               s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    void createModel() {
+        model_ = glp_create_prob();
+        glp_set_prob_name(model_, "gempp");
+    }
+
+    // Assigns GLPK columns to the variables not mapped yet: the active ones get the next
+    // column numbers, inactive ones none (0)
+    void mapColumns(const VariableStore& vars) {
+        int added = 0;
+        int next = glp_get_num_cols(model_);
+        glp_col_.reserve(vars.size());
+        for (int col = static_cast<int>(glp_col_.size()); col < vars.size(); ++col) {
+            if (vars.isActive(col)) {
+                glp_col_.push_back(++next);
+                ++added;
+            } else {
+                glp_col_.push_back(0);
+            }
+        }
+        if (added > 0) glp_add_cols(model_, added);
+    }
+
+    // Variable col is GLPK column glp_col_[col] (if active), constraint r is GLPK row r + 1
     void buildModel() {
-        // Add variables
-        for (auto& pair : lp_->getVariables()) {
-            Variable* v = pair.second;
-            addVariable(v);
+        // Add variables (columns referenced by streamed rows already exist)
+        const VariableStore& vars = lp_->getVariables();
+        mapColumns(vars);
+        column_count_ = vars.size();
+        for (int col = 0; col < vars.size(); ++col) {
+            if (glp_col_[col] > 0) {
+                addVariable(vars, col);
+            } else if (vars.isActive(col)) {
+                throw Exception("Variable " + vars.getName(col) +
+                                " was activated after the model was compacted");
+            }
         }
 
-        // Add constraints
-        for (auto* c : lp_->getConstraints()) {
-            addConstraint(c);
+        // Add stored constraints, after the streamed ones
+        const ConstraintStore& constraints = lp_->getConstraints();
+        int stored = constraints.getStoredRowCount();
+        if (stored > 0) {
+            int first = glp_add_rows(model_, stored);
+            for (int r = 0; r < stored; ++r) {
+                setRowBounds(first + r, constraints.getRelation(r), constraints.getRHS(r));
+                setRow(first + r, constraints.getColumns(r), constraints.getCoefficients(r),
+                       constraints.getRowSize(r));
+            }
         }
 
         // Set objective
         setObjective();
-
-        // Load matrix
-        initMatrix();
     }
 
-    void addVariable(Variable* v) {
-        glp_add_cols(model_, 1);
-        int idx = var_order_.size() + 1;
-        var_order_[v->getID()] = idx;
+    void addVariable(const VariableStore& vars, int col) {
+        int idx = glp_col_[col];
 
-        glp_set_col_name(model_, idx, v->getID().c_str());
-        glp_set_col_bnds(model_, idx, GLP_DB, v->getLowerBound(), v->getUpperBound());
-
-        switch (v->getType()) {
-            case Variable::BINARY:
+        // Kind first: GLP_BV resets the bounds to [0,1]
+        switch (vars.getType(col)) {
+            case VariableStore::BINARY:
                 glp_set_col_kind(model_, idx, GLP_BV);
                 break;
-            case Variable::BOUNDED:
+            case VariableStore::BOUNDED:
                 glp_set_col_kind(model_, idx, GLP_IV);
                 break;
-            case Variable::CONTINUOUS:
+            case VariableStore::CONTINUOUS:
                 glp_set_col_kind(model_, idx, GLP_CV);
                 break;
         }
-    }
 
-    void addConstraint(LinearConstraint* c) {
-        glp_add_rows(model_, 1);
-        int idx = const_order_.size() + 1;
-        const_order_[c->getID()] = idx;
-
-        glp_set_row_name(model_, idx, c->getID().c_str());
+        // Deactivated variables are fixed (GLPK rejects GLP_DB with equal bounds)
+        int low = vars.getLowerBound(col);
+        int up = vars.getUpperBound(col);
+        glp_set_col_bnds(model_, idx, low == up ? GLP_FX : GLP_DB, low, up);
+    }
 
-        double bound = c->getRHS() - c->getLinearExpression()->getConst();
-        switch (c->getRelation()) {
-            case LinearConstraint::LESS_EQ:
+    void setRowBounds(int idx, ConstraintStore::Relation relation, double bound) {
+        switch (relation) {
+            case ConstraintStore::LESS_EQ:
                 glp_set_row_bnds(model_, idx, GLP_UP, 0, bound);
                 break;
-            case LinearConstraint::GREATER_EQ:
+            case ConstraintStore::GREATER_EQ:
                 glp_set_row_bnds(model_, idx, GLP_LO, bound, 0);
                 break;
-            case LinearConstraint::EQUAL:
+            case ConstraintStore::EQUAL:
                 glp_set_row_bnds(model_, idx, GLP_FX, bound, bound);
                 break;
         }
+    }
 
-        nz_ += c->getLinearExpression()->getTerms().size();
+    // Loads one row; GLPK reads 1-based index/value arrays, so the row is shifted into
+    // reusable buffers
+    void setRow(int idx, const int* cols, const double* coefs, int size) {
+        if (static_cast<int>(row_ind_.size()) < size + 1) {
+            row_ind_.resize(size + 1);
+            row_val_.resize(size + 1);
+        }
+        for (int t = 0; t < size; ++t) {
+            row_ind_[t + 1] = glp_col_[cols[t]];
+            row_val_[t + 1] = coefs[t];
+            if (row_ind_[t + 1] == 0) {
+                throw Exception("Constraint uses variable " + std::to_string(cols[t]) +
+                                ", which was inactive when the model was compacted");
+            }
+        }
+        glp_set_mat_row(model_, idx, size, row_ind_.data(), row_val_.data());
     }
 
     void setObjective() {
@@ -221,44 +723,44 @@ private:
 
         LinearExpression* obj = lp_->getObjective();
         for (const auto& pair : obj->getTerms()) {
-            Variable* var = pair.first;
-            double coeff = pair.second;
-            glp_set_obj_coef(model_, var_order_[var->getID()], coeff);
+            if (glp_col_[pair.first] > 0) glp_set_obj_coef(model_, glp_col_[pair.first], pair.second);
         }
         glp_set_obj_coef(model_, 0, obj->getConst());
     }
 
-    void initMatrix() {
-        int* ia = (int*)calloc(1 + nz_, sizeof(int));
-        int* ja = (int*)calloc(1 + nz_, sizeof(int));
-        double* ar = (double*)calloc(1 + nz_, sizeof(double));
-
-        int cpt = 0;
-        for (auto* c : lp_->getConstraints()) {
-            LinearExpression* le = c->getLinearExpression();
-            for (const auto& pair : le->getTerms()) {
-                ++cpt;
-                ia[cpt] = const_order_[c->getID()];
-                ja[cpt] = var_order_[pair.first->getID()];
-                ar[cpt] = pair.second;
-            }
-        }
-
-        glp_load_matrix(model_, nz_, ia, ja, ar);
-
-        free(ia);
-        free(ja);
-        free(ar);
-    }
-
     LinearProgram* lp_;
     glp_prob* model_;
     glp_iocp config_;
     bool relaxed_ = false;
     bool first_feasible_ = false;
-    std::unordered_map<std::string, int> var_order_;
-    std::unordered_map<std::string, int> const_order_;
-    int nz_ = 0;
+    Status status_;
+    int column_count_ = 0;       // variables of the formulation (solution size)
+    std::vector<double> warm_start_;  // 1-based GLPK column values, empty if none
+    bool warm_start_offered_ = false;
+    Rounding rounding_;
+    Separator separator_;
+    int lazy_rows_ = 0;
+    int lazy_rounds_ = 0;
+    int rounding_calls_ = 0;
+    int rounding_improvements_ = 0;
+    bool original_columns_ = false;  // the search runs on the model's columns (no presolve)
+    std::vector<double> node_values_;
+    std::vector<Bounds> col_bounds_;  // 1-based, saved before the search
+    std::vector<Bounds> row_bounds_;
+    std::chrono::steady_clock::time_point solve_start_;
+    double first_incumbent_ms_ = -1.0;
+    int node_count_ = 0;
+    double lower_bound_ = -INFINITY;
+    double tree_bound_ = -INFINITY;  // global bound of the last branch and bound
+    double bound_ = -INFINITY;
+    int time_limit_ms_ = INT_MAX;
+    int node_limit_ = 0;
+    double mip_gap_ = 1e-9;
+    const volatile std::sig_atomic_t* stop_flag_ = nullptr;
+    bool bound_met_ = false;
+    std::vector<int> glp_col_;  // GLPK column of each variable, 0 if left out
+    std::vector<int> row_ind_;
+    std::vector<double> row_val_;
 };
 
 } // namespace gempp
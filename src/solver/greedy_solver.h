@@ -3,8 +3,8 @@
 
 #include "../model/problem.h"
 #include "../model/graph.h"
+#include "matching.h"
 #include <vector>
-#include <unordered_map>
 #include <algorithm>
 #include <cmath>
 
@@ -18,59 +18,37 @@ namespace gempp {
  * - Tries to match each pattern vertex to a target vertex
  * - Greedily selects matches that preserve edge structure
  * - Returns an upper bound on the minimal extension
+ *
+ * Edges of multiplicity m count as m parallel copies, matched onto free parallel copies of
+ * the target edge. Undirected edges (stored once, origin <= target) may be matched in either
+ * orientation. The result is a FEASIBLE Matching (no bound).
  */
 class GreedySolver {
 public:
-    struct Result {
-        double objective;
-        std::unordered_map<std::string, double> solution;
-        std::vector<int> vertex_matching;  // vertex_matching[i] = k means pattern vertex i -> target vertex k
-        std::vector<int> edge_matching;    // edge_matching[ij] = kl means pattern edge ij -> target edge kl
-    };
-
     GreedySolver(Problem* pb) : pb_(pb) {}
 
     /**
      * Solve using greedy matching.
      * For MCSM (minimal extension), tries to find a matching that minimizes unmatched elements.
      */
-    Result solve() {
-        Result result;
-        result.objective = 0.0;
-
+    Matching solve() {
         Graph* pattern = pb_->getQuery();
         Graph* target = pb_->getTarget();
 
         int nVP = pattern->getVertexCount();
         int nVT = target->getVertexCount();
-        int nEP = pattern->getEdgeCount();
-        int nET = target->getEdgeCount();
 
-        // Initialize matchings as unmatched (-1)
-        result.vertex_matching.assign(nVP, -1);
-        result.edge_matching.assign(nEP, -1);
+        // Target vertex of each pattern vertex (-1: unmatched)
+        std::vector<int> vertex_matching(nVP, -1);
 
-        // Track which target vertices/edges are used
+        // Track which target vertices are used
         std::vector<bool> target_vertex_used(nVT, false);
-        std::vector<bool> target_edge_used(nET, false);
-
-        // Build adjacency for target edges: (src,dst) -> edge index
-        std::unordered_map<int, std::unordered_map<int, int>> target_adj;
-        for (int kl = 0; kl < nET; ++kl) {
-            Edge* e = target->getEdge(kl);
-            int k = e->getOrigin()->getIndex();
-            int l = e->getTarget()->getIndex();
-            target_adj[k][l] = kl;
-            if (!target->isDirected()) {
-                target_adj[l][k] = kl;  // Undirected: both directions
-            }
-        }
 
         // Sort pattern vertices by degree (descending) - match high-degree first
         std::vector<int> pattern_order(nVP);
         for (int i = 0; i < nVP; ++i) pattern_order[i] = i;
         std::sort(pattern_order.begin(), pattern_order.end(), [&](int a, int b) {
-            return pattern->getVertex(a)->getDegree() > pattern->getVertex(b)->getDegree();
+            return pattern->getDegree(a) > pattern->getDegree(b);
         });
 
         // Greedy vertex matching
@@ -84,27 +62,17 @@ public:
 
                 // Score: how many already-matched neighbors can be edge-matched
                 int score = 0;
-                Vertex* pv = pattern->getVertex(i);
-                Vertex* tv = target->getVertex(k);
-
-                // Check edges from this pattern vertex
-                for (Edge* pe : pv->getEdges(Vertex::EDGE_IN_OUT)) {
-                    int j = (pe->getOrigin()->getIndex() == i)
-                            ? pe->getTarget()->getIndex()
-                            : pe->getOrigin()->getIndex();
-
-                    if (result.vertex_matching[j] >= 0) {
-                        // Neighbor j is already matched to some target vertex l
-                        int l = result.vertex_matching[j];
-                        // Check if there's an edge k-l in target
-                        if (target_adj[k].count(l) || target_adj[l].count(k)) {
-                            ++score;
-                        }
-                    }
+
+                // Check edges from and to this pattern vertex
+                for (int j : pattern->getOutNeighbors(i)) {
+                    score += adjacentScore(target, k, vertex_matching[j]);
+                }
+                for (int ji : pattern->getInEdges(i)) {
+                    score += adjacentScore(target, k, vertex_matching[pattern->getOrigin(ji)]);
                 }
 
                 // Degree compatibility: prefer similar degrees
-                int degree_diff = std::abs(pv->getDegree() - tv->getDegree());
+                int degree_diff = std::abs(pattern->getDegree(i) - target->getDegree(k));
                 int adjusted_score = score * 1000 - degree_diff;
 
                 if (adjusted_score > best_score) {
@@ -114,65 +82,104 @@ public:
             }
 
             if (best_k >= 0) {
-                result.vertex_matching[i] = best_k;
+                vertex_matching[i] = best_k;
                 target_vertex_used[best_k] = true;
-
-                // Record in solution map
-                std::string var_id = "x_" + std::to_string(i) + "," + std::to_string(best_k);
-                result.solution[var_id] = 1.0;
             }
         }
 
-        // Now match edges based on vertex matching
-        for (int ij = 0; ij < nEP; ++ij) {
-            Edge* pe = pattern->getEdge(ij);
-            int i = pe->getOrigin()->getIndex();
-            int j = pe->getTarget()->getIndex();
-
-            int k = result.vertex_matching[i];
-            int l = result.vertex_matching[j];
-
-            if (k >= 0 && l >= 0) {
-                // Both endpoints are matched - check if corresponding edge exists
-                int kl = -1;
-                if (target_adj[k].count(l)) {
-                    kl = target_adj[k][l];
-                } else if (!target->isDirected() && target_adj[l].count(k)) {
-                    kl = target_adj[l][k];
-                }
+        return complete(vertex_matching);
+    }
 
-                if (kl >= 0 && !target_edge_used[kl]) {
-                    result.edge_matching[ij] = kl;
-                    target_edge_used[kl] = true;
+    /**
+     * Completes a vertex assignment (target vertex of each pattern vertex, -1: unmatched)
+     * into a matching: the copies of each pattern edge whose endpoints are both matched go to
+     * free parallel copies of the corresponding target edge. The objective is the minimal
+     * extension cost of the result (unmatched pattern vertices and arcs).
+     */
+    Matching complete(const std::vector<int>& vertex_matching) const {
+        Matching result(pb_);
+        const Graph* pattern = pb_->getQuery();
+        const Graph* target = pb_->getTarget();
+        int nVP = pattern->getVertexCount();
+        int nEP = pattern->getEdgeCount();
+        int nET = target->getEdgeCount();
 
-                    std::string var_id = "y_" + std::to_string(ij) + "," + std::to_string(kl);
-                    result.solution[var_id] = 1.0;
+        for (int i = 0; i < nVP; ++i) {
+            if (vertex_matching[i] >= 0) result.matchVertices(i, vertex_matching[i]);
+        }
+
+        // Copies of each target edge still free
+        std::vector<int> target_edge_free(nET);
+        for (int kl = 0; kl < nET; ++kl) target_edge_free[kl] = target->getMultiplicity(kl);
+
+        int unmatched_edges = 0;
+        for (int ij = 0; ij < nEP; ++ij) {
+            int i = pattern->getOrigin(ij);
+            int j = pattern->getTarget(ij);
+
+            int k = vertex_matching[i];
+            int l = vertex_matching[j];
+            int copies = pattern->getMultiplicity(ij);
+
+            // Both endpoints are matched - take free parallel copies of the corresponding edge
+            while (k >= 0 && l >= 0 && copies > 0) {
+                int kl = findFreeEdge(target, k, l, target_edge_free);
+                if (kl < 0 && !target->isDirected()) {
+                    kl = findFreeEdge(target, l, k, target_edge_free);
                 }
+                if (kl < 0) break;
+
+                int taken = std::min(copies, target_edge_free[kl]);
+                target_edge_free[kl] -= taken;
+                copies -= taken;
+                result.matchEdges(ij, kl, taken);
             }
+            // Counted per arc, as in the ILP formulations (an undirected edge is two arcs)
+            unmatched_edges += copies * pattern->getArcMultiplicity(ij) / pattern->getMultiplicity(ij);
         }
 
         // Calculate objective: number of unmatched pattern elements
         int unmatched_vertices = 0;
-        int unmatched_edges = 0;
 
         for (int i = 0; i < nVP; ++i) {
-            if (result.vertex_matching[i] < 0) {
+            if (vertex_matching[i] < 0) {
                 ++unmatched_vertices;
             }
         }
 
-        for (int ij = 0; ij < nEP; ++ij) {
-            if (result.edge_matching[ij] < 0) {
-                ++unmatched_edges;
-            }
-        }
-
-        result.objective = unmatched_vertices + unmatched_edges;
+        result.setObjective(unmatched_vertices + unmatched_edges);
+        result.setStatus(Matching::FEASIBLE);
 
         return result;
     }
 
 private:
+    // Edge indices k -> l in the target (consecutive run of parallel edges)
+    static std::pair<int, int> edgeRun(const Graph* g, int k, int l) {
+        IndexSpan nbrs = g->getOutNeighbors(k);
+        auto range = std::equal_range(nbrs.begin(), nbrs.end(), l);
+        int base = *g->getOutEdges(k).begin();
+        return {base + static_cast<int>(range.first - nbrs.begin()),
+                base + static_cast<int>(range.second - nbrs.begin())};
+    }
+
+    // 1 if the already matched neighbour image l is adjacent to k (either direction)
+    static int adjacentScore(const Graph* g, int k, int l) {
+        if (l < 0) return 0;
+        auto kl = edgeRun(g, k, l);
+        if (kl.first != kl.second) return 1;
+        auto lk = edgeRun(g, l, k);
+        return lk.first != lk.second ? 1 : 0;
+    }
+
+    static int findFreeEdge(const Graph* g, int k, int l, const std::vector<int>& free) {
+        auto run = edgeRun(g, k, l);
+        for (int kl = run.first; kl < run.second; ++kl) {
+            if (free[kl] > 0) return kl;
+        }
+        return -1;
+    }
+
     Problem* pb_;
 };
 
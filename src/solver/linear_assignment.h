@@ -0,0 +1,257 @@
+#ifndef V2_LINEAR_ASSIGNMENT_H
+#define V2_LINEAR_ASSIGNMENT_H
+
+#include "../core/matrix.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace gempp {
+
+// Linear sum assignment problem (LSAP): a minimum-cost assignment of the rows of a cost
+// matrix to distinct columns (of the columns to distinct rows if there are more rows).
+//
+// Hungarian method with shortest augmenting paths (Jonker-Volgenant style potentials), in
+// O(n^2 m) time for n <= m. Infinite costs mark forbidden pairs; a row (column) that can only
+// be given forbidden pairs is left unassigned.
+class LinearAssignment {
+public:
+    // Column of each row, -1 if unassigned
+    static std::vector<int> solve(const Matrix<double>& cost) {
+        int rows = cost.getRowsNumber();
+        int cols = cost.getColumnsNumber();
+        if (rows <= cols) return solveWide(cost, false);
+
+        // More rows than columns: assign the columns of the transpose, then invert
+        std::vector<int> rowOf = solveWide(cost, true);
+        std::vector<int> colOf(rows, -1);
+        for (int k = 0; k < cols; ++k) {
+            if (rowOf[k] >= 0) colOf[rowOf[k]] = k;
+        }
+        return colOf;
+    }
+
+    // Total cost of an assignment returned by solve()
+    static double totalCost(const Matrix<double>& cost, const std::vector<int>& assignment) {
+        double total = 0.0;
+        for (int i = 0; i < static_cast<int>(assignment.size()); ++i) {
+            if (assignment[i] >= 0) total += cost(i, assignment[i]);
+        }
+        return total;
+    }
+
+    // Buffers of minimumCost(), kept by callers that solve many small assignments (the
+    // branch and bounds) so that repeated solves allocate nothing
+    struct Workspace {
+        std::vector<double> u;
+        std::vector<double> v;
+        std::vector<double> minv;
+        std::vector<int> p;
+        std::vector<int> way;
+        std::vector<char> used;
+    };
+
+    // Optimum of the LSAP of rows <= cols finite costs, cost(r, c) being cost[r * cols + c]
+    static double minimumCost(const double* cost, int rows, int cols, Workspace& ws) {
+        if (rows == 0) return 0.0;
+        hungarian(rows, cols, [cost, cols](int i, int j) { return cost[i * cols + j]; }, ws);
+        double total = 0.0;
+        for (int j = 1; j <= cols; ++j) {
+            if (ws.p[j] != 0) total += cost[(ws.p[j] - 1) * cols + j - 1];
+        }
+        return total;
+    }
+
+    // LSAP whose rows and columns come in groups of identical ones: cost(a, b) is the cost of
+    // any row of group a with any column of group b, rows[a] and cols[b] the group sizes.
+    // Returns the number of rows of each group assigned to columns of each group, with the
+    // optimum of solve() on the expanded matrix.
+    //
+    // Transportation problem between the groups, solved by successive shortest paths (with
+    // potentials, from costs shifted to be non-negative) that each carry as many rows as their
+    // bottleneck allows: O((A + B)^2) per path for A row and B column groups, whatever the
+    // group sizes.
+    static Matrix<int> solveGrouped(const Matrix<double>& cost, const std::vector<int>& rows,
+                                    const std::vector<int>& cols) {
+        int A = cost.getRowsNumber();
+        int B = cost.getColumnsNumber();
+        Matrix<int> flow(A, B, 0);
+
+        // Every path uses one row-column pair more than it cancels, so a constant shift of
+        // the costs does not change which flow of a given size is cheapest
+        double lowest = INFINITY;
+        for (int a = 0; a < A; ++a) {
+            for (int b = 0; b < B; ++b) {
+                if (std::isfinite(cost(a, b))) lowest = std::min(lowest, cost(a, b));
+            }
+        }
+        if (!std::isfinite(lowest)) return flow;
+        auto at = [&](int a, int b) { return cost(a, b) - lowest; };
+
+        // Nodes: source 0, row groups 1..A, column groups A+1..A+B, sink A+B+1
+        int n = A + B + 2;
+        int sink = n - 1;
+        const double inf = std::numeric_limits<double>::infinity();
+        std::vector<int> sent(A, 0), received(B, 0), prev(n);
+        std::vector<double> potential(n, 0.0), dist(n);
+        std::vector<char> done(n);
+        while (true) {
+            std::fill(dist.begin(), dist.end(), inf);
+            std::fill(done.begin(), done.end(), 0);
+            dist[0] = 0.0;
+            while (true) {
+                int x = -1;
+                for (int y = 0; y < n; ++y) {
+                    if (!done[y] && dist[y] < inf && (x < 0 || dist[y] < dist[x])) x = y;
+                }
+                if (x < 0 || x == sink) break;
+                done[x] = 1;
+                auto relax = [&](int y, double c) {
+                    double d = dist[x] + c + potential[x] - potential[y];
+                    if (d < dist[y]) {
+                        dist[y] = d;
+                        prev[y] = x;
+                    }
+                };
+                if (x == 0) {
+                    for (int a = 0; a < A; ++a) {
+                        if (sent[a] < rows[a]) relax(1 + a, 0.0);
+                    }
+                } else if (x <= A) {
+                    for (int b = 0; b < B; ++b) {
+                        if (std::isfinite(cost(x - 1, b))) relax(1 + A + b, at(x - 1, b));
+                    }
+                } else {
+                    int b = x - 1 - A;
+                    for (int a = 0; a < A; ++a) {
+                        if (flow(a, b) > 0) relax(1 + a, -at(a, b));
+                    }
+                    if (received[b] < cols[b]) relax(sink, 0.0);
+                }
+            }
+            if (dist[sink] == inf) break;
+            for (int y = 0; y < n; ++y) potential[y] += std::min(dist[y], dist[sink]);
+
+            // Bottleneck of the path, then push it
+            int b0 = prev[sink] - 1 - A;
+            int amount = cols[b0] - received[b0];
+            for (int y = prev[sink]; y != 0; y = prev[y]) {
+                int x = prev[y];
+                if (x == 0) {
+                    amount = std::min(amount, rows[y - 1] - sent[y - 1]);
+                } else if (x > A) {
+                    amount = std::min(amount, flow(y - 1, x - 1 - A));
+                }
+            }
+            received[b0] += amount;
+            for (int y = prev[sink]; y != 0; y = prev[y]) {
+                int x = prev[y];
+                if (x == 0) {
+                    sent[y - 1] += amount;
+                } else if (x <= A) {
+                    flow(x - 1, y - 1 - A) += amount;
+                } else {
+                    flow(y - 1, x - 1 - A) -= amount;
+                }
+            }
+        }
+        return flow;
+    }
+
+private:
+    // n <= m rows (columns of cost if transposed) assigned to m columns
+    static std::vector<int> solveWide(const Matrix<double>& cost, bool transposed) {
+        int n = transposed ? cost.getColumnsNumber() : cost.getRowsNumber();
+        int m = transposed ? cost.getRowsNumber() : cost.getColumnsNumber();
+        std::vector<int> result(n, -1);
+        if (n == 0) return result;
+
+        // Forbidden pairs get a cost above any path of allowed pairs, so that they are only
+        // used when a row has no alternative, and are dropped afterwards
+        double big = 1.0;
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < m; ++j) {
+                double c = transposed ? cost(j, i) : cost(i, j);
+                if (std::isfinite(c)) big += std::abs(c);
+            }
+        }
+        big *= 2.0;
+        auto at = [&](int i, int j) {
+            double c = transposed ? cost(j, i) : cost(i, j);
+            return std::isfinite(c) ? c : big;
+        };
+
+        Workspace ws;
+        hungarian(n, m, at, ws);
+        for (int j = 1; j <= m; ++j) {
+            if (ws.p[j] == 0) continue;
+            int i = ws.p[j] - 1;
+            double c = transposed ? cost(j - 1, i) : cost(i, j - 1);
+            if (std::isfinite(c)) result[i] = j - 1;
+        }
+        return result;
+    }
+
+    // Hungarian method on n <= m rows with costs at(i, j) (0-based): afterwards ws.p[j] is the
+    // row of column j, both 1-based (0: none)
+    template <class At>
+    static void hungarian(int n, int m, At at, Workspace& ws) {
+        // 1-based: row 0 and column 0 are the virtual source of each augmenting path
+        const double inf = std::numeric_limits<double>::infinity();
+        std::vector<double>& u = ws.u;
+        std::vector<double>& v = ws.v;
+        std::vector<double>& minv = ws.minv;
+        std::vector<int>& p = ws.p;
+        std::vector<int>& way = ws.way;
+        std::vector<char>& used = ws.used;
+        u.assign(n + 1, 0.0);
+        v.assign(m + 1, 0.0);
+        minv.assign(m + 1, 0.0);
+        p.assign(m + 1, 0);
+        way.assign(m + 1, 0);
+        used.assign(m + 1, 0);
+        for (int i = 1; i <= n; ++i) {
+            p[0] = i;
+            int j0 = 0;
+            std::fill(minv.begin(), minv.end(), inf);
+            std::fill(used.begin(), used.end(), 0);
+            do {
+                used[j0] = 1;
+                int i0 = p[j0];
+                int j1 = 0;
+                double delta = inf;
+                for (int j = 1; j <= m; ++j) {
+                    if (used[j]) continue;
+                    double reduced = at(i0 - 1, j - 1) - u[i0] - v[j];
+                    if (reduced < minv[j]) {
+                        minv[j] = reduced;
+                        way[j] = j0;
+                    }
+                    if (minv[j] < delta) {
+                        delta = minv[j];
+                        j1 = j;
+                    }
+                }
+                for (int j = 0; j <= m; ++j) {
+                    if (used[j]) {
+                        u[p[j]] += delta;
+                        v[j] -= delta;
+                    } else {
+                        minv[j] -= delta;
+                    }
+                }
+                j0 = j1;
+            } while (p[j0] != 0);
+            do {
+                int j1 = way[j0];
+                p[j0] = p[j1];
+                j0 = j1;
+            } while (j0 != 0);
+        }
+    }
+};
+
+} // namespace gempp
+
+#endif // V2_LINEAR_ASSIGNMENT_H
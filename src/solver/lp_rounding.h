@@ -0,0 +1,49 @@
+#ifndef V2_LP_ROUNDING_H
+#define V2_LP_ROUNDING_H
+
+#include "../core/matrix.h"
+#include "../formulation/matching_layout.h"
+#include "../model/problem.h"
+#include "greedy_solver.h"
+#include "linear_assignment.h"
+#include <cmath>
+#include <vector>
+
+namespace gempp {
+
+// LP-guided rounding for the MatchingLayout formulations, run as a primal heuristic at the
+// branch-and-bound nodes (GLPKSolver::setRounding).
+//
+// The fractional x values of a node are rounded to the vertex assignment of maximum total
+// x value, solved as a LinearAssignment; GreedySolver::complete then matches the pattern edges
+// onto free target edge copies between the assigned vertices, as the greedy solver does.
+class LPRounding {
+public:
+    explicit LPRounding(Problem* pb)
+        : greedy_(pb), layout_(pb), nVP_(pb->getQuery()->getVertexCount()),
+          nVT_(pb->getTarget()->getVertexCount())
+    {}
+
+    // x/y column values of the rounded matching. relaxation holds the LP value of each column,
+    // NaN for columns left out of the model: those vertex pairs are never assigned.
+    std::vector<double> round(const std::vector<double>& relaxation) const {
+        Matrix<double> cost(nVP_, nVT_);
+        for (int i = 0; i < nVP_; ++i) {
+            for (int k = 0; k < nVT_; ++k) {
+                double x = relaxation[layout_.x(i, k)];
+                cost(i, k) = std::isnan(x) ? INFINITY : -x;
+            }
+        }
+        return greedy_.complete(LinearAssignment::solve(cost)).toColumns();
+    }
+
+private:
+    GreedySolver greedy_;
+    MatchingLayout layout_;
+    int nVP_;
+    int nVT_;
+};
+
+} // namespace gempp
+
+#endif // V2_LP_ROUNDING_H
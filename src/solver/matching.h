@@ -0,0 +1,192 @@
+#ifndef V2_MATCHING_H
+#define V2_MATCHING_H
+
+#include "../formulation/matching_layout.h"
+#include "../model/graph.h"
+#include "../model/problem.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gempp {
+
+// Appends the arcs edge e stands for: (origin, target), plus the reverse arc for an
+// undirected edge that is not a self-loop
+inline void appendArcs(const Graph* g, int e, std::vector<std::pair<int, int>>& arcs) {
+    arcs.push_back({g->getOrigin(e), g->getTarget(e)});
+    if (!g->isDirected() && g->getOrigin(e) != g->getTarget(e)) {
+        arcs.push_back({g->getTarget(e), g->getOrigin(e)});
+    }
+}
+
+// Result of a solver: the vertex assignment in both directions, the edge copies matched
+// (per pattern edge, per target edge and as (ij, kl, copies) triples), and the objective,
+// bound and status of the solve. Everything is indexed by vertex or edge, so consumers read
+// it in time linear in the size of the graphs.
+class Matching {
+public:
+    enum Status {
+        OPTIMAL,     // proven optimal (for a relaxation: optimal for the relaxation)
+        FEASIBLE,    // valid matching, optimality not proven
+        INFEASIBLE,
+        UNBOUNDED,
+        NOT_SOLVED
+    };
+
+    // (pattern edge, target edge, number of parallel copies matched)
+    struct EdgeMatch {
+        int pattern;
+        int target;
+        int copies;
+    };
+
+    explicit Matching(const Problem* pb)
+        : pb_(pb), target_vertex_(pb->getQuery()->getVertexCount(), -1),
+          pattern_vertex_(pb->getTarget()->getVertexCount(), -1),
+          pattern_edge_copies_(pb->getQuery()->getEdgeCount(), 0),
+          target_edge_copies_(pb->getTarget()->getEdgeCount(), 0), objective_(INFINITY),
+          bound_(-INFINITY), status_(NOT_SOLVED)
+    {}
+
+    // Matching read from x/y column values of the MatchingLayout formulations: x >= 0.5 is
+    // a vertex pair, y rounds to its number of matched copies (values below 0.5 are none)
+    static Matching fromColumns(const Problem* pb, const std::vector<double>& values) {
+        Matching matching(pb);
+        MatchingLayout layout(pb);
+        for (int col = 0; col < static_cast<int>(values.size()); ++col) {
+            if (values[col] < 0.5) continue;
+            std::pair<int, int> p = layout.decode(col);
+            if (layout.isX(col)) {
+                matching.matchVertices(p.first, p.second);
+            } else {
+                matching.matchEdges(p.first, p.second, static_cast<int>(std::lround(values[col])));
+            }
+        }
+        return matching;
+    }
+
+    // Inverse of fromColumns: x/y column values of this matching in the MatchingLayout
+    std::vector<double> toColumns() const {
+        MatchingLayout layout(pb_);
+        std::vector<double> values(layout.size(), 0.0);
+        for (int i = 0; i < static_cast<int>(target_vertex_.size()); ++i) {
+            if (target_vertex_[i] >= 0) values[layout.x(i, target_vertex_[i])] = 1.0;
+        }
+        for (const EdgeMatch& m : edge_matches_) {
+            values[layout.y(m.pattern, m.target)] += m.copies;
+        }
+        return values;
+    }
+
+    void matchVertices(int i, int k) {
+        target_vertex_[i] = k;
+        pattern_vertex_[k] = i;
+    }
+
+    // Adds copies of pattern edge ij matched onto target edge kl
+    void matchEdges(int ij, int kl, int copies) {
+        if (copies <= 0) return;
+        pattern_edge_copies_[ij] += copies;
+        target_edge_copies_[kl] += copies;
+        edge_matches_.push_back({ij, kl, copies});
+    }
+
+    const Problem* getProblem() const { return pb_; }
+
+    // Target vertex of each pattern vertex / pattern vertex of each target vertex, -1 if none
+    const std::vector<int>& getTargetVertices() const { return target_vertex_; }
+    const std::vector<int>& getPatternVertices() const { return pattern_vertex_; }
+    int getTargetVertex(int i) const { return target_vertex_[i]; }
+    int getPatternVertex(int k) const { return pattern_vertex_[k]; }
+
+    // Matched copies of each pattern edge / each target edge
+    const std::vector<int>& getPatternEdgeCopies() const { return pattern_edge_copies_; }
+    const std::vector<int>& getTargetEdgeCopies() const { return target_edge_copies_; }
+
+    // Edge matches in the order they were added (by (ij, kl) for fromColumns)
+    const std::vector<EdgeMatch>& getEdgeMatches() const { return edge_matches_; }
+
+    // Unmatched pattern / target vertices, ascending
+    std::vector<int> getUnmatchedPatternVertices() const { return unmatched(target_vertex_); }
+    std::vector<int> getUnmatchedTargetVertices() const { return unmatched(pattern_vertex_); }
+
+    // Arcs of the unmatched pattern / target edge copies (one per copy and arc; an undirected
+    // edge is two arcs), by edge index
+    std::vector<std::pair<int, int>> getUnmatchedPatternArcs() const {
+        return unmatchedArcs(pb_->getQuery(), pattern_edge_copies_);
+    }
+    std::vector<std::pair<int, int>> getUnmatchedTargetArcs() const {
+        return unmatchedArcs(pb_->getTarget(), target_edge_copies_);
+    }
+
+    double getObjective() const { return objective_; }
+    void setObjective(double objective) { objective_ = objective; }
+
+    // Proven bound on the optimal objective (-inf if unknown)
+    double getBound() const { return bound_; }
+    void setBound(double bound) { bound_ = bound; }
+
+    Status getStatus() const { return status_; }
+    void setStatus(Status status) { status_ = status; }
+
+    bool hasSolution() const { return status_ == OPTIMAL || status_ == FEASIBLE; }
+
+    // Relative gap (objective - bound) / |objective| of a solution (0 if proven optimal,
+    // inf if there is no solution or no bound)
+    double getGap() const {
+        if (status_ == OPTIMAL) return 0.0;
+        if (!hasSolution() || !std::isfinite(objective_) || !std::isfinite(bound_)) return INFINITY;
+        if (std::abs(objective_) < 1e-9) return 0.0;
+        return std::max(0.0, (objective_ - bound_) / std::abs(objective_));
+    }
+
+    // " (bound B, gap G%)" after the objective of a result not proven optimal, "" otherwise
+    std::string getBoundNote() const {
+        if (status_ == OPTIMAL || status_ == INFEASIBLE || !std::isfinite(bound_)) return "";
+        std::ostringstream note;
+        note << " (bound " << bound_;
+        if (std::isfinite(getGap())) {
+            note << ", gap " << std::fixed << std::setprecision(1) << 100.0 * getGap() << "%";
+        }
+        note << ")";
+        return note.str();
+    }
+
+private:
+    static std::vector<int> unmatched(const std::vector<int>& assignment) {
+        std::vector<int> result;
+        for (int v = 0; v < static_cast<int>(assignment.size()); ++v) {
+            if (assignment[v] < 0) result.push_back(v);
+        }
+        return result;
+    }
+
+    static std::vector<std::pair<int, int>> unmatchedArcs(const Graph* g,
+                                                          const std::vector<int>& copies) {
+        std::vector<std::pair<int, int>> arcs;
+        for (int e = 0; e < g->getEdgeCount(); ++e) {
+            for (int c = std::min(copies[e], g->getMultiplicity(e)); c < g->getMultiplicity(e); ++c) {
+                appendArcs(g, e, arcs);
+            }
+        }
+        return arcs;
+    }
+
+    const Problem* pb_;
+    std::vector<int> target_vertex_;
+    std::vector<int> pattern_vertex_;
+    std::vector<int> pattern_edge_copies_;
+    std::vector<int> target_edge_copies_;
+    std::vector<EdgeMatch> edge_matches_;
+    double objective_;
+    double bound_;
+    Status status_;
+};
+
+} // namespace gempp
+
+#endif // V2_MATCHING_H
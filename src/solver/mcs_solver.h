@@ -0,0 +1,468 @@
+#ifndef V2_MCS_SOLVER_H
+#define V2_MCS_SOLVER_H
+
+#include "../core/matrix.h"
+#include "../core/types.h"
+#include "../model/graph.h"
+#include "../model/problem.h"
+#include "greedy_solver.h"
+#include "linear_assignment.h"
+#include "matching.h"
+#include "search_common.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace gempp {
+
+// Exact minimal extension and graph edit distance without an LP: branch and bound over vertex
+// mappings, searching a maximum common edge subgraph in the manner of the McSplit solvers.
+//
+// With unit edit costs and zero substitution costs, once the vertex mapping f is fixed the
+// matched arcs are the sum over ordered vertex pairs (i, j), self-loops included, of
+// min(w_P(i, j), w_T(f(i), f(j))), w_G(a, b) being the arc copies from a to b (an undirected
+// edge of multiplicity m is m arcs each way). Mapping a vertex never costs an arc, so optimal
+// mappings match min(nVP, nVT) vertices, leaving out exactly max(0, nVP - nVT) pattern
+// vertices, and the search maximizes the matched arcs A (objectives in NativeSearch).
+//
+// Pattern vertices are mapped one at a time, the next one being the free vertex with the most
+// arcs to the mapped ones (McSplit branches on its most constrained label class). McSplit's
+// label classes, vertices with the same adjacency to the mapped pairs, have a counterpart for
+// arc counts: gain(u, v), the arcs u -> v would match with the pairs mapped so far, maintained
+// incrementally in O(deg(i) * deg(k)) per pair (i, k). A node is pruned unless
+//   matched + sum over free u of max over free v of (gain(u, v) + min(out_P(u), out_T(v)))
+// beats the incumbent, out counting arcs towards free vertices; the arcs between free vertices
+// are also capped by their total on either side, and the pattern vertices to leave out drop
+// their terms. Nodes this does not prune get the same bound with the maxima replaced by a
+// LinearAssignment of the free vertices, which is injective.
+//
+// The search is depth-first by default. setBestFirst() expands the open node of largest bound
+// first (A*, whose first complete mapping popped is optimal) as long as the open nodes fit the
+// memory limit; past it, the remaining open nodes are finished depth-first, best first.
+// The result is completed into edge matches by GreedySolver::complete.
+class MCSSolver : public NativeSearch {
+public:
+    explicit MCSSolver(Problem* pb)
+        : NativeSearch(pb), pb_(pb), greedy_(pb), nVP_(pb->getQuery()->getVertexCount()),
+          nVT_(pb->getTarget()->getVertexCount())
+    {
+        if (pb->getQuery()->isDirected() != pb->getTarget()->isDirected()) {
+            throw Exception("Pattern and target graphs must be both directed or both undirected");
+        }
+        if (!zeroSubstitutionCosts(pb)) {
+            throw Exception("The native search only supports zero substitution costs");
+        }
+        buildArcs(pb->getQuery(), pattern_arcs_, pattern_loops_);
+        buildArcs(pb->getTarget(), target_arcs_, target_loops_);
+
+        // Static tie-breaks: total arcs per pattern vertex, and target vertices without any
+        // arc (interchangeable: only the first free one is tried)
+        degree_.assign(nVP_, 0);
+        for (int u = 0; u < nVP_; ++u) {
+            degree_[u] = pattern_loops_[u];
+            for (const Arcs& a : pattern_arcs_[u]) degree_[u] += a.out + a.in;
+        }
+        isolated_.assign(nVT_, 0);
+        for (int v = 0; v < nVT_; ++v) isolated_[v] = target_arcs_[v].empty() && target_loops_[v] == 0;
+    }
+
+    // Vertex assignment to start from (target vertex of each pattern vertex, -1: unmatched),
+    // e.g. GreedySolver's; the search then only looks for strictly better mappings
+    void setWarmStart(const std::vector<int>& vertex_matching) { warm_start_ = vertex_matching; }
+
+    // Best-first (A*) search instead of depth-first, with the open nodes kept within
+    // memory_bytes (then finished depth-first)
+    void setBestFirst(bool best_first) { best_first_ = best_first; }
+    void setMemoryLimit(size_t memory_bytes) { memory_limit_ = memory_bytes; }
+
+    // Best-first search: most open nodes held at once, and whether the memory limit was hit
+    size_t getPeakOpenNodes() const { return peak_open_; }
+    bool isMemoryLimited() const { return memory_limited_; }
+
+    // Milliseconds from the start of the last solve to its first incumbent (warm start
+    // included), negative if it found none
+    double getFirstIncumbentTime() const { return first_incumbent_ms_; }
+
+    Matching solve() {
+        startSearch();
+        memory_limited_ = false;
+        peak_open_ = 0;
+        first_incumbent_ms_ = -1.0;
+        resetState();
+
+        best_score_ = -1;
+        best_.assign(nVP_, -1);
+        if (!warm_start_.empty()) {
+            best_ = fillMapping(warm_start_, nVT_);
+            best_score_ = scoreOf(best_);
+            first_incumbent_ms_ = 0.0;
+        }
+        root_bound_ = score_ + bound();
+        frontier_ = root_bound_;
+        if (!closed()) {
+            if (best_first_) {
+                bestFirst();
+            } else {
+                search();
+            }
+        }
+
+        Matching result = greedy_.complete(best_);
+        finish(result, best_score_, frontier_);
+        return result;
+    }
+
+private:
+    // Open node of the best-first search: its bound and mapping (assigned_)
+    struct OpenNode {
+        long bound;
+        int depth;
+        std::vector<int> assigned;
+    };
+
+    static constexpr int FREE = -1;
+    static constexpr int LEFT_OUT = -2;
+
+    // Arcs from target vertex k to l
+    int targetArcs(int k, int l) const {
+        const std::vector<Arcs>& arcs = target_arcs_[k];
+        auto it = std::lower_bound(arcs.begin(), arcs.end(), l,
+                                   [](const Arcs& a, int v) { return a.vertex < v; });
+        return (it != arcs.end() && it->vertex == l) ? it->out : 0;
+    }
+
+    // Arcs a vertex assignment matches
+    long scoreOf(const std::vector<int>& mapping) const {
+        long score = 0;
+        for (int i = 0; i < nVP_; ++i) {
+            int k = mapping[i];
+            if (k < 0) continue;
+            score += std::min(pattern_loops_[i], target_loops_[k]);
+            for (const Arcs& a : pattern_arcs_[i]) {
+                int l = mapping[a.vertex];
+                if (l >= 0) score += std::min(a.out, targetArcs(k, l));
+            }
+        }
+        return score;
+    }
+
+    // Empty mapping
+    void resetState() {
+        gain_ = Matrix<int>(nVP_, nVT_);
+        for (int u = 0; u < nVP_; ++u) {
+            for (int v = 0; v < nVT_; ++v) gain_(u, v) = std::min(pattern_loops_[u], target_loops_[v]);
+        }
+        assigned_.assign(nVP_, FREE);
+        used_.assign(nVT_, 0);
+        anchored_.assign(nVP_, 0);
+        free_count_ = nVP_;
+        skip_left_ = std::max(0, nVP_ - nVT_);
+        score_ = 0;
+        initFreeArcs(pattern_arcs_, pattern_out_, pattern_inner_);
+        initFreeArcs(target_arcs_, target_out_, target_inner_);
+    }
+
+    static void initFreeArcs(const std::vector<std::vector<Arcs>>& arcs, std::vector<int>& out,
+                             long& inner) {
+        out.assign(arcs.size(), 0);
+        inner = 0;
+        for (size_t v = 0; v < arcs.size(); ++v) {
+            for (const Arcs& a : arcs[v]) out[v] += a.out;
+            inner += out[v];
+        }
+    }
+
+    // State of a mapping (assigned_ of a node), rebuilt from the empty mapping: the updates of
+    // map() and leaveOut() do not depend on their order
+    void restore(const std::vector<int>& assigned) {
+        resetState();
+        for (int i = 0; i < nVP_; ++i) {
+            if (assigned[i] >= 0) {
+                map(i, assigned[i], 1);
+            } else if (assigned[i] == LEFT_OUT) {
+                leaveOut(i, 1);
+            }
+        }
+    }
+
+    // Maps pattern vertex i onto target vertex k (sign 1) or undoes it (sign -1)
+    void map(int i, int k, int sign) {
+        if (sign > 0) {
+            assigned_[i] = k;
+            used_[k] = 1;
+            score_ += gain_(i, k);
+        }
+        removePattern(i, sign);
+        for (const Arcs& b : target_arcs_[k]) {
+            target_out_[b.vertex] -= sign * b.in;
+            if (!used_[b.vertex]) target_inner_ -= sign * (b.out + b.in);
+        }
+        for (const Arcs& a : pattern_arcs_[i]) {
+            anchored_[a.vertex] += sign * (a.out + a.in);
+            for (const Arcs& b : target_arcs_[k]) {
+                gain_(a.vertex, b.vertex) += sign * (std::min(a.in, b.in) + std::min(a.out, b.out));
+            }
+        }
+        if (sign < 0) {
+            score_ -= gain_(i, k);
+            assigned_[i] = FREE;
+            used_[k] = 0;
+        }
+    }
+
+    // Takes pattern vertex i out of (sign 1) or back into (sign -1) the free vertices
+    void removePattern(int i, int sign) {
+        free_count_ -= sign;
+        for (const Arcs& a : pattern_arcs_[i]) {
+            pattern_out_[a.vertex] -= sign * a.in;
+            if (assigned_[a.vertex] == FREE) pattern_inner_ -= sign * (a.out + a.in);
+        }
+    }
+
+    void leaveOut(int i, int sign) {
+        if (sign > 0) assigned_[i] = LEFT_OUT;
+        removePattern(i, sign);
+        skip_left_ -= sign;
+        if (sign < 0) assigned_[i] = FREE;
+    }
+
+    // Upper bound on the arcs the free vertices can still match
+    long bound() {
+        best_gain_.clear();
+        best_total_.clear();
+        for (int u = 0; u < nVP_; ++u) {
+            if (assigned_[u] != FREE) continue;
+            int gain = 0;
+            int total = 0;
+            for (int v = 0; v < nVT_; ++v) {
+                if (used_[v]) continue;
+                int g = gain_(u, v);
+                gain = std::max(gain, g);
+                total = std::max(total, g + std::min(pattern_out_[u], target_out_[v]));
+            }
+            best_gain_.push_back(gain);
+            best_total_.push_back(total);
+        }
+        long with_inner = sumDroppingSmallest(best_gain_) + std::min(pattern_inner_, target_inner_);
+        return std::min(with_inner, sumDroppingSmallest(best_total_));
+    }
+
+    // Sum of values without the skip_left_ smallest (the vertices left out match nothing)
+    long sumDroppingSmallest(std::vector<int>& values) const {
+        int drop = std::min(skip_left_, static_cast<int>(values.size()));
+        if (drop > 0) std::nth_element(values.begin(), values.begin() + drop, values.end());
+        long sum = 0;
+        for (size_t r = drop; r < values.size(); ++r) sum += values[r];
+        return sum;
+    }
+
+    // bound() with each free pattern vertex given its own free target vertex: a maximum
+    // weight assignment of gain(u, v) + min(out_P(u), out_T(v)). There are exactly
+    // skip_left_ more free pattern vertices than free target vertices, so the vertices the
+    // assignment leaves out are as many as must be.
+    long assignmentBound(long cheap) {
+        rows_.clear();
+        cols_.clear();
+        for (int u = 0; u < nVP_; ++u) {
+            if (assigned_[u] == FREE) rows_.push_back(u);
+        }
+        for (int v = 0; v < nVT_; ++v) {
+            if (!used_[v]) cols_.push_back(v);
+        }
+        int n = static_cast<int>(rows_.size());
+        int m = static_cast<int>(cols_.size());
+        if (n < 2 || m < 2) return cheap;
+        Matrix<double> cost(n, m);
+        for (int r = 0; r < n; ++r) {
+            int u = rows_[r];
+            for (int c = 0; c < m; ++c) {
+                int v = cols_[c];
+                cost(r, c) = -(gain_(u, v) + std::min(pattern_out_[u], target_out_[v]));
+            }
+        }
+        long total = -std::lround(LinearAssignment::totalCost(cost, LinearAssignment::solve(cost)));
+        return std::min(cheap, total);
+    }
+
+    // Bound of the current node, the assignment only computed if the cheap bound leaves it
+    // above the incumbent
+    long nodeBound() {
+        long cheap = bound();
+        if (score_ + cheap <= best_score_) return cheap;
+        return assignmentBound(cheap);
+    }
+
+    void recordLeaf() {
+        if (score_ <= best_score_) return;
+        best_score_ = score_;
+        best_ = assigned_;
+        for (int& k : best_) k = std::max(k, -1);
+        if (first_incumbent_ms_ < 0.0) first_incumbent_ms_ = elapsedMs();
+    }
+
+    // Free pattern vertex with the most arcs to the mapped ones, then the most arcs
+    int branchVertex() const {
+        int i = -1;
+        for (int u = 0; u < nVP_; ++u) {
+            if (assigned_[u] != FREE) continue;
+            if (i < 0 || anchored_[u] > anchored_[i] ||
+                (anchored_[u] == anchored_[i] && degree_[u] > degree_[i])) {
+                i = u;
+            }
+        }
+        return i;
+    }
+
+    // Free target vertices for i, by decreasing promise
+    std::vector<int> candidates(int i) const {
+        std::vector<std::pair<int, int>> scored;
+        bool isolated_tried = false;
+        for (int k = 0; k < nVT_; ++k) {
+            if (used_[k]) continue;
+            if (isolated_[k]) {
+                if (isolated_tried) continue;
+                isolated_tried = true;
+            }
+            scored.push_back({gain_(i, k) + std::min(pattern_out_[i], target_out_[k]), k});
+        }
+        std::stable_sort(scored.begin(), scored.end(),
+                         [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+                             return a.first > b.first;
+                         });
+        std::vector<int> result;
+        for (const auto& s : scored) result.push_back(s.second);
+        return result;
+    }
+
+    void search() {
+        ++node_count_;
+        if (free_count_ == 0) {
+            recordLeaf();
+            return;
+        }
+        if (score_ + nodeBound() <= best_score_ || closed() || outOfBudget()) return;
+
+        int i = branchVertex();
+        for (int k : candidates(i)) {
+            map(i, k, 1);
+            search();
+            map(i, k, -1);
+            if (closed() || stopped_) return;
+        }
+        if (skip_left_ > 0) {
+            leaveOut(i, 1);
+            search();
+            leaveOut(i, -1);
+        }
+    }
+
+    // A*: the open node of largest bound (deepest on ties) is expanded next; its bound is
+    // the bound of the whole search (frontier_)
+    void bestFirst() {
+        auto lower = [](const OpenNode& a, const OpenNode& b) {
+            return a.bound < b.bound || (a.bound == b.bound && a.depth < b.depth);
+        };
+        size_t node_bytes = sizeof(OpenNode) + nVP_ * sizeof(int) + 2 * sizeof(void*);
+        std::vector<OpenNode> open;
+        open.push_back({root_bound_, 0, assigned_});
+
+        while (!open.empty()) {
+            std::pop_heap(open.begin(), open.end(), lower);
+            OpenNode node = std::move(open.back());
+            open.pop_back();
+            frontier_ = std::max(best_score_, node.bound);
+            if (node.bound <= best_score_ || closed() || outOfBudget()) return;
+
+            restore(node.assigned);
+            if (free_count_ == 0) {
+                recordLeaf();
+                continue;
+            }
+            if (memory_limited_) {
+                // Over the memory limit: each open node is finished depth-first, so only the
+                // heap has to be held
+                search();
+                if (closed() || stopped_) return;
+                continue;
+            }
+
+            ++node_count_;
+            int i = branchVertex();
+            auto expand = [&]() {
+                if (free_count_ == 0) {
+                    recordLeaf();
+                    return;
+                }
+                long bound = score_ + nodeBound();
+                if (bound > best_score_) {
+                    open.push_back({bound, node.depth + 1, assigned_});
+                    std::push_heap(open.begin(), open.end(), lower);
+                }
+            };
+            for (int k : candidates(i)) {
+                map(i, k, 1);
+                expand();
+                map(i, k, -1);
+            }
+            if (skip_left_ > 0) {
+                leaveOut(i, 1);
+                expand();
+                leaveOut(i, -1);
+            }
+            peak_open_ = std::max(peak_open_, open.size());
+            if (open.size() * node_bytes > memory_limit_) memory_limited_ = true;
+        }
+        frontier_ = best_score_;
+    }
+
+    // Closed by the lower bound or the bound of the search (the root, or the A* frontier)
+    bool closed() { return NativeSearch::closed(best_score_, std::min(root_bound_, frontier_)); }
+
+    bool outOfBudget() { return NativeSearch::outOfBudget(best_score_); }
+
+    Problem* pb_;
+    GreedySolver greedy_;
+    int nVP_;
+    int nVT_;
+    std::vector<std::vector<Arcs>> pattern_arcs_;
+    std::vector<std::vector<Arcs>> target_arcs_;
+    std::vector<int> pattern_loops_;
+    std::vector<int> target_loops_;
+    std::vector<int> degree_;
+    std::vector<char> isolated_;
+
+    // Search state
+    Matrix<int> gain_;
+    std::vector<int> assigned_;  // target vertex, FREE or LEFT_OUT per pattern vertex
+    std::vector<char> used_;
+    std::vector<int> anchored_;  // arcs to the mapped pattern vertices
+    std::vector<int> pattern_out_;  // arcs towards free vertices
+    std::vector<int> target_out_;
+    long pattern_inner_ = 0;  // arcs between free vertices
+    long target_inner_ = 0;
+    int free_count_ = 0;
+    int skip_left_ = 0;
+    long score_ = 0;
+    std::vector<int> best_gain_;
+    std::vector<int> best_total_;
+    std::vector<int> rows_;
+    std::vector<int> cols_;
+
+    long best_score_ = -1;
+    std::vector<int> best_;
+    long root_bound_ = 0;
+    long frontier_ = 0;  // bound on the score of the unexplored nodes
+    std::vector<int> warm_start_;
+
+    bool best_first_ = false;
+    size_t memory_limit_ = static_cast<size_t>(1) << 30;
+    size_t peak_open_ = 0;
+    bool memory_limited_ = false;
+    double first_incumbent_ms_ = -1.0;
+};
+
+} // namespace gempp
+
+#endif // V2_MCS_SOLVER_H
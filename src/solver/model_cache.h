@@ -0,0 +1,91 @@
+#ifndef V2_MODEL_CACHE_H
+#define V2_MODEL_CACHE_H
+
+#include "../core/types.h"
+#include "../model/graph.h"
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+namespace gempp {
+
+// On-disk cache of built GLPK models (see GLPKSolver::writeModel/readModel).
+//
+// A model is stored as <dir>/<key>.mps, where the key is a 64-bit FNV-1a hash of both
+// graphs (type, vertex count, edges with their multiplicity) and of a settings string that
+// covers everything else the model depends on (formulation, costs, pruning bound). Bump
+// VERSION whenever a formulation changes the model it builds for the same input.
+class ModelCache {
+public:
+    static constexpr const char* VERSION = "gempp-model-1";
+
+    explicit ModelCache(const std::string& dir) : dir_(dir) {}
+
+    static uint64_t key(const Graph* pattern, const Graph* target, const std::string& settings) {
+        uint64_t h = OFFSET;
+        hashString(h, VERSION);
+        hashGraph(h, pattern);
+        hashGraph(h, target);
+        hashString(h, settings);
+        return h;
+    }
+
+    // Path of the model file for key (the file may not exist)
+    std::string path(uint64_t key) const {
+        char name[17];
+        std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+        return (std::filesystem::path(dir_) / (std::string(name) + ".mps")).string();
+    }
+
+    bool contains(uint64_t key) const {
+        std::error_code ec;
+        return std::filesystem::is_regular_file(path(key), ec);
+    }
+
+    // Creates the cache directory if needed
+    void prepare() const {
+        std::error_code ec;
+        std::filesystem::create_directories(dir_, ec);
+        if (ec) {
+            throw Exception("Cannot create model cache directory '" + dir_ + "': " + ec.message());
+        }
+    }
+
+private:
+    static constexpr uint64_t OFFSET = 14695981039346656037ULL;
+    static constexpr uint64_t PRIME = 1099511628211ULL;
+
+    static void hashBytes(uint64_t& h, const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t b = 0; b < size; ++b) {
+            h ^= bytes[b];
+            h *= PRIME;
+        }
+    }
+
+    static void hashInt(uint64_t& h, int64_t value) { hashBytes(h, &value, sizeof(value)); }
+
+    static void hashString(uint64_t& h, const std::string& s) {
+        hashInt(h, static_cast<int64_t>(s.size()));
+        hashBytes(h, s.data(), s.size());
+    }
+
+    static void hashGraph(uint64_t& h, const Graph* g) {
+        hashInt(h, g->getType());
+        hashInt(h, g->getVertexCount());
+        hashInt(h, g->getEdgeCount());
+        for (int e = 0; e < g->getEdgeCount(); ++e) {
+            hashInt(h, g->getOrigin(e));
+            hashInt(h, g->getTarget(e));
+            hashInt(h, g->getMultiplicity(e));
+        }
+    }
+
+    std::string dir_;
+};
+
+} // namespace gempp
+
+#endif // V2_MODEL_CACHE_H
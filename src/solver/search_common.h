@@ -0,0 +1,210 @@
+#ifndef V2_SEARCH_COMMON_H
+#define V2_SEARCH_COMMON_H
+
+#include "../model/graph.h"
+#include "../model/problem.h"
+#include "matching.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <vector>
+
+namespace gempp {
+
+// Pieces shared by the native solvers (MCSSolver, BitParallelSolver, SubgraphMatcher,
+// BipartiteGED): the arc lists they read the graphs into, the zero-cost check they all
+// require, and the objective, budgets and stopping rule of the two branch and bounds.
+
+// Arcs between a vertex and one of its neighbours (self-loops excluded)
+struct Arcs {
+    int vertex;
+    int out;  // arcs towards vertex
+    int in;   // arcs from vertex
+};
+
+// Neighbours of each vertex with the arc copies each way, by neighbour (parallel edges merged
+// into one entry), and the self-loop copies
+inline void buildArcs(const Graph* g, std::vector<std::vector<Arcs>>& arcs, std::vector<int>& loops) {
+    int n = g->getVertexCount();
+    std::vector<std::vector<Arcs>> raw(n);
+    loops.assign(n, 0);
+    for (int e = 0; e < g->getEdgeCount(); ++e) {
+        int a = g->getOrigin(e);
+        int b = g->getTarget(e);
+        int m = g->getMultiplicity(e);
+        if (a == b) {
+            loops[a] += m;
+            continue;
+        }
+        bool both = !g->isDirected();
+        raw[a].push_back({b, m, both ? m : 0});
+        raw[b].push_back({a, both ? m : 0, m});
+    }
+
+    arcs.assign(n, std::vector<Arcs>());
+    for (int v = 0; v < n; ++v) {
+        std::sort(raw[v].begin(), raw[v].end(),
+                  [](const Arcs& x, const Arcs& y) { return x.vertex < y.vertex; });
+        for (const Arcs& entry : raw[v]) {
+            if (!arcs[v].empty() && arcs[v].back().vertex == entry.vertex) {
+                arcs[v].back().out += entry.out;
+                arcs[v].back().in += entry.in;
+            } else {
+                arcs[v].push_back(entry);
+            }
+        }
+    }
+}
+
+// True if vertex and edge substitutions of pb cost nothing (the unit-cost objectives the
+// native solvers are built on)
+inline bool zeroSubstitutionCosts(const Problem* pb) {
+    auto zero = [](const CostTable& table) { return table.isUniform() && table.getUniform() == 0.0; };
+    return zero(pb->getCostTable(true)) && zero(pb->getCostTable(false));
+}
+
+// The assignment (target vertex of each pattern vertex, -1: unmatched) with its unmatched
+// pattern vertices given free target vertices, as long as there are both (matching a vertex
+// never loses an arc)
+inline std::vector<int> fillMapping(std::vector<int> mapping, int nVT) {
+    std::vector<char> used(nVT, 0);
+    for (int k : mapping) {
+        if (k >= 0) used[k] = 1;
+    }
+    int k = 0;
+    for (int& target : mapping) {
+        if (target >= 0) continue;
+        while (k < nVT && used[k]) ++k;
+        if (k == nVT) break;
+        target = k;
+        used[k] = 1;
+    }
+    return mapping;
+}
+
+// Base of the branch and bounds that maximize the arcs A matched by a mapping of
+// min(nVP, nVT) vertices (MCSSolver, BitParallelSolver). Scores are arc counts; the objective
+// of a score is
+// - minimal extension (Problem::SUBGRAPH): max(0, nVP - nVT) + arcs(P) - A,
+// - edit distance (Problem::GED): |nVP - nVT| + arcs(P) + arcs(T) - 2A.
+// It holds the lower bound and budgets, and decides when a search is closed (its incumbent
+// proven optimal) or stopped (a budget or the gap reached).
+class NativeSearch {
+public:
+    // Proven lower bound on the optimum (see LowerBounds): the search stops as soon as its
+    // incumbent reaches it, and reports the incumbent as optimal
+    void setLowerBound(double bound) { lower_bound_ = bound; }
+    double getLowerBound() const { return lower_bound_; }
+
+    // True if the last solve was closed by the lower bound (or by the bound of the search)
+    bool isBoundMet() const { return bound_met_; }
+
+    // Budgets, as for GLPKSolver: once one runs out the best mapping is returned as a feasible
+    // solution with the bound of the unexplored nodes, or, without any mapping yet, the result
+    // is NOT_SOLVED (infinite objective) with that bound.
+    // Wall-clock limit in seconds (<= 0: none)
+    void setTimeLimit(double seconds) { time_limit_ms_ = seconds > 0.0 ? seconds * 1000.0 : INFINITY; }
+    // Search node limit (0: none); it only counts once there is a first incumbent, so that a
+    // limit of 1 (--fast) stops at the first mapping found
+    void setNodeLimit(int nodes) { node_limit_ = nodes; }
+    // Relative gap (incumbent - bound) / |incumbent| at which the search stops (default 1e-9)
+    void setMipGap(double gap) { mip_gap_ = gap; }
+    // The search stops once *flag becomes non-zero; nullptr: none
+    void setStopFlag(const volatile std::sig_atomic_t* flag) { stop_flag_ = flag; }
+
+    // Search nodes of the last solve
+    long getNodeCount() const { return node_count_; }
+
+protected:
+    explicit NativeSearch(const Problem* pb) {
+        int nVP = pb->getQuery()->getVertexCount();
+        int nVT = pb->getTarget()->getVertexCount();
+        long arcsP = pb->getQuery()->getTotalArcMultiplicity();
+        long arcsT = pb->getTarget()->getTotalArcMultiplicity();
+        if (pb->getType() == Problem::GED) {
+            constant_ = std::abs(nVP - nVT) + arcsP + arcsT;
+            arc_weight_ = 2;
+        } else {
+            constant_ = std::max(0, nVP - nVT) + arcsP;
+            arc_weight_ = 1;
+        }
+    }
+
+    // Clock, node count and outcome of a new solve
+    void startSearch() {
+        start_ = std::chrono::steady_clock::now();
+        node_count_ = 0;
+        stopped_ = false;
+        bound_met_ = false;
+    }
+
+    // Objective of a mapping of min(nVP, nVT) vertices matching score arcs
+    double objectiveOf(long score) const { return static_cast<double>(constant_ - arc_weight_ * score); }
+
+    // True once the incumbent (best_score, -1: none) is proven optimal by the lower bound or
+    // by bound_score, the bound of the search on the score, or meets the gap (which stops the
+    // search like a budget)
+    bool closed(long best_score, long bound_score) {
+        if (best_score < 0) return false;
+        double objective = objectiveOf(best_score);
+        double bound = std::max(lower_bound_, objectiveOf(bound_score));
+        if (objective <= bound + 1e-6) {
+            bound_met_ = true;
+            return true;
+        }
+        if (objective - bound <= mip_gap_ * (std::abs(objective) + DBL_EPSILON)) stopped_ = true;
+        return stopped_;
+    }
+
+    // True (and stopped_ set) once a budget runs out or the stop flag is raised; the node
+    // limit waits for a first incumbent (best_score >= 0)
+    bool outOfBudget(long best_score) {
+        if (stopped_) return true;
+        if ((best_score >= 0 && node_limit_ > 0 && node_count_ >= node_limit_) ||
+            (stop_flag_ && *stop_flag_) ||
+            ((node_count_ & 255) == 0 && elapsedMs() >= time_limit_ms_)) {
+            stopped_ = true;
+        }
+        return stopped_;
+    }
+
+    // Objective, status and bound of the result of a search that ended with best_score (-1:
+    // stopped before any incumbent) and bound_score (the bound of its unexplored nodes)
+    void finish(Matching& result, long best_score, long bound_score) const {
+        double bound = std::max(lower_bound_, objectiveOf(bound_score));
+        if (best_score < 0) {
+            result.setObjective(INFINITY);
+            result.setStatus(Matching::NOT_SOLVED);
+            result.setBound(bound);
+            return;
+        }
+        result.setObjective(objectiveOf(best_score));
+        bool optimal = !stopped_ || bound_met_;
+        result.setStatus(optimal ? Matching::OPTIMAL : Matching::FEASIBLE);
+        result.setBound(optimal ? result.getObjective() : bound);
+    }
+
+    double elapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_)
+            .count();
+    }
+
+    long constant_ = 0;    // objective of a mapping matching no arc
+    long arc_weight_ = 1;  // objective decrease per matched arc
+    double lower_bound_ = -INFINITY;
+    bool bound_met_ = false;
+    double time_limit_ms_ = INFINITY;
+    int node_limit_ = 0;
+    double mip_gap_ = 1e-9;
+    const volatile std::sig_atomic_t* stop_flag_ = nullptr;
+    bool stopped_ = false;
+    long node_count_ = 0;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace gempp
+
+#endif // V2_SEARCH_COMMON_H
@@ -0,0 +1,281 @@
+#ifndef V2_SUBGRAPH_MATCHER_H
+#define V2_SUBGRAPH_MATCHER_H
+
+#include "../core/types.h"
+#include "../model/graph.h"
+#include "../model/problem.h"
+#include "greedy_solver.h"
+#include "matching.h"
+#include "search_common.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace gempp {
+
+// Native subgraph isomorphism (monomorphism) test, in the manner of VF2/VF3: backtracking over
+// injective vertex mappings that keep every pattern arc, multiplicities and self-loops
+// included (w_P(i, j) <= w_T(f(i), f(j)) for every ordered pair). Such a mapping is exactly a
+// minimal extension of 0, so it answers the common yes-instances without building a model.
+//
+// - Candidate filtering: a target vertex is a candidate for a pattern vertex only if it has
+//   at least as many self-loops, distinct out-/in-neighbours and out-/in-arcs.
+// - Static order (VF3's greatest constraint first): the next pattern vertex is the one with
+//   the most neighbours already ordered, then the highest degree. Candidates of a vertex with
+//   an ordered neighbour are the neighbours of that neighbour's image, the one with fewest.
+// - Each candidate is checked against the ordered neighbours only, with a bit matrix of the
+//   target arcs (up to MAX_BITSET_VERTICES target vertices) before the arc counts.
+//
+// solve() runs under the budgets and returns an OPTIMAL matching of objective 0 if it finds an
+// embedding, INFEASIBLE with bound 1 (an extension of at least one element) if it proves there
+// is none, and NOT_SOLVED if a budget ran out first.
+class SubgraphMatcher {
+public:
+    // Largest target whose arcs are also kept as a bit matrix (8 MB)
+    static constexpr int MAX_BITSET_VERTICES = 8192;
+
+    explicit SubgraphMatcher(Problem* pb)
+        : pb_(pb), greedy_(pb), nVP_(pb->getQuery()->getVertexCount()),
+          nVT_(pb->getTarget()->getVertexCount())
+    {
+        if (pb->getQuery()->isDirected() != pb->getTarget()->isDirected()) {
+            throw Exception("Pattern and target graphs must be both directed or both undirected");
+        }
+        if (!zeroSubstitutionCosts(pb)) {
+            throw Exception("The subgraph isomorphism test only supports zero substitution costs");
+        }
+        buildArcs(pb->getQuery(), pattern_arcs_, pattern_loops_);
+        buildArcs(pb->getTarget(), target_arcs_, target_loops_);
+        signature(pattern_arcs_, pattern_loops_, pattern_signature_);
+        signature(target_arcs_, target_loops_, target_signature_);
+
+        if (nVT_ <= MAX_BITSET_VERTICES) {
+            words_ = (nVT_ + 63) / 64;
+            adjacency_.assign(static_cast<size_t>(nVT_) * words_, 0);
+            for (int k = 0; k < nVT_; ++k) {
+                for (const Arcs& b : target_arcs_[k]) {
+                    if (b.out > 0) adjacency_[k * words_ + b.vertex / 64] |= uint64_t(1) << (b.vertex % 64);
+                }
+            }
+        }
+    }
+
+    // Wall-clock limit in seconds (<= 0: none)
+    void setTimeLimit(double seconds) { time_limit_ms_ = seconds > 0.0 ? seconds * 1000.0 : INFINITY; }
+    // Search node limit (0: none)
+    void setNodeLimit(long nodes) { node_limit_ = nodes; }
+
+    // Search nodes (candidates mapped) of the last solve
+    long getNodeCount() const { return node_count_; }
+
+    Matching solve() {
+        start_ = std::chrono::steady_clock::now();
+        node_count_ = 0;
+        Matching result(pb_);
+        result.setObjective(INFINITY);
+
+        std::vector<int> mapping;
+        Outcome outcome = NONE;
+        if (nVP_ <= nVT_ && pb_->getQuery()->getTotalArcMultiplicity() <=
+                                pb_->getTarget()->getTotalArcMultiplicity()) {
+            outcome = search(mapping);
+        }
+
+        if (outcome == FOUND) {
+            result = greedy_.complete(mapping);
+            result.setBound(0.0);
+            result.setStatus(Matching::OPTIMAL);
+        } else if (outcome == NONE) {
+            result.setBound(1.0);
+            result.setStatus(Matching::INFEASIBLE);
+        }
+        return result;
+    }
+
+private:
+    enum Outcome { FOUND, NONE, STOPPED };
+
+    // Self-loops, distinct out-/in-neighbours and out-/in-arcs of a vertex
+    struct Signature {
+        int loops;
+        int outNeighbours;
+        int inNeighbours;
+        int outArcs;
+        int inArcs;
+    };
+
+    static void signature(const std::vector<std::vector<Arcs>>& arcs, const std::vector<int>& loops,
+                          std::vector<Signature>& signatures) {
+        signatures.assign(arcs.size(), Signature{0, 0, 0, 0, 0});
+        for (size_t v = 0; v < arcs.size(); ++v) {
+            Signature& s = signatures[v];
+            s.loops = loops[v];
+            for (const Arcs& a : arcs[v]) {
+                s.outNeighbours += a.out > 0;
+                s.inNeighbours += a.in > 0;
+                s.outArcs += a.out;
+                s.inArcs += a.in;
+            }
+        }
+    }
+
+    bool compatible(int u, int v) const {
+        const Signature& p = pattern_signature_[u];
+        const Signature& t = target_signature_[v];
+        return p.loops <= t.loops && p.outNeighbours <= t.outNeighbours &&
+               p.inNeighbours <= t.inNeighbours && p.outArcs <= t.outArcs && p.inArcs <= t.inArcs;
+    }
+
+    // Arcs from target vertex k to l
+    int targetArcs(int k, int l) const {
+        if (!adjacency_.empty() && !(adjacency_[k * words_ + l / 64] >> (l % 64) & 1)) return 0;
+        const std::vector<Arcs>& arcs = target_arcs_[k];
+        auto it = std::lower_bound(arcs.begin(), arcs.end(), l,
+                                   [](const Arcs& a, int v) { return a.vertex < v; });
+        return (it != arcs.end() && it->vertex == l) ? it->out : 0;
+    }
+
+    // True if the arcs of pattern vertex i with the ordered vertices all exist between k and
+    // their images; the bit matrix rejects most candidates before any count is read
+    bool consistent(int i, int k, const std::vector<int>& mapping) const {
+        for (const Arcs& a : before_[i]) {
+            int l = mapping[a.vertex];
+            if (a.out > 0 && (a.out == 1 ? !hasArc(k, l) : targetArcs(k, l) < a.out)) return false;
+            if (a.in > 0 && (a.in == 1 ? !hasArc(l, k) : targetArcs(l, k) < a.in)) return false;
+        }
+        return true;
+    }
+
+    bool hasArc(int k, int l) const {
+        if (!adjacency_.empty()) return adjacency_[k * words_ + l / 64] >> (l % 64) & 1;
+        return targetArcs(k, l) > 0;
+    }
+
+    // Greatest-constraint-first order, and the arcs of each vertex to the vertices before it.
+    // Vertices wait in a heap by (ordered neighbours, degree), stale entries being skipped
+    void buildOrder() {
+        order_.clear();
+        before_.assign(nVP_, std::vector<Arcs>());
+        std::vector<int> ordered_neighbours(nVP_, 0);
+        std::vector<char> placed(nVP_, 0);
+        using Entry = std::pair<std::pair<int, int>, int>;
+        std::priority_queue<Entry> waiting;
+        for (int u = 0; u < nVP_; ++u) {
+            waiting.push({{0, static_cast<int>(pattern_arcs_[u].size())}, -u});
+        }
+        while (!waiting.empty()) {
+            Entry top = waiting.top();
+            waiting.pop();
+            int next = -top.second;
+            if (placed[next] || top.first.first != ordered_neighbours[next]) continue;
+            placed[next] = 1;
+            order_.push_back(next);
+            for (const Arcs& a : pattern_arcs_[next]) {
+                if (placed[a.vertex]) {
+                    before_[next].push_back(a);
+                } else {
+                    int w = a.vertex;
+                    waiting.push({{++ordered_neighbours[w], static_cast<int>(pattern_arcs_[w].size())}, -w});
+                }
+            }
+        }
+    }
+
+    // Depth-first search over order_, with an explicit stack (depth up to nVP)
+    Outcome search(std::vector<int>& mapping) {
+        buildOrder();
+        mapping.assign(nVP_, -1);
+        std::vector<char> used(nVT_, 0);
+
+        // Per depth: image of the ordered neighbour whose neighbours are the candidates (-1:
+        // every target vertex), and the position of the next candidate
+        std::vector<int> source(nVP_, -1);
+        std::vector<int> position(nVP_, 0);
+
+        int depth = 0;
+        enter(0, mapping, source, position);
+        while (depth >= 0) {
+            if (depth == nVP_) return FOUND;
+            int i = order_[depth];
+            if (mapping[i] >= 0) {
+                used[mapping[i]] = 0;
+                mapping[i] = -1;
+            }
+
+            // Next candidate of the vertex at this depth
+            int k = -1;
+            int s = source[depth];
+            int count = s < 0 ? nVT_ : static_cast<int>(target_arcs_[s].size());
+            while (position[depth] < count) {
+                int v = s < 0 ? position[depth] : target_arcs_[s][position[depth]].vertex;
+                ++position[depth];
+                if (!used[v] && compatible(i, v) && consistent(i, v, mapping)) {
+                    k = v;
+                    break;
+                }
+            }
+            if (k < 0) {
+                --depth;
+                continue;
+            }
+
+            ++node_count_;
+            if ((node_limit_ > 0 && node_count_ >= node_limit_) ||
+                ((node_count_ & 1023) == 0 && elapsedMs() >= time_limit_ms_)) {
+                return STOPPED;
+            }
+            mapping[i] = k;
+            used[k] = 1;
+            ++depth;
+            if (depth < nVP_) enter(depth, mapping, source, position);
+        }
+        return NONE;
+    }
+
+    // Candidate source of the vertex at depth: the image of its ordered neighbour with the
+    // fewest neighbours
+    void enter(int depth, const std::vector<int>& mapping, std::vector<int>& source,
+               std::vector<int>& position) const {
+        int best = -1;
+        for (const Arcs& a : before_[order_[depth]]) {
+            int l = mapping[a.vertex];
+            if (best < 0 || target_arcs_[l].size() < target_arcs_[best].size()) best = l;
+        }
+        source[depth] = best;
+        position[depth] = 0;
+    }
+
+    double elapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_)
+            .count();
+    }
+
+    Problem* pb_;
+    GreedySolver greedy_;
+    int nVP_;
+    int nVT_;
+    std::vector<std::vector<Arcs>> pattern_arcs_;
+    std::vector<std::vector<Arcs>> target_arcs_;
+    std::vector<int> pattern_loops_;
+    std::vector<int> target_loops_;
+    std::vector<Signature> pattern_signature_;
+    std::vector<Signature> target_signature_;
+    std::vector<uint64_t> adjacency_;  // arc k -> l: bit l of row k (empty past the size limit)
+    int words_ = 0;  // words per row of adjacency_
+
+    std::vector<int> order_;
+    std::vector<std::vector<Arcs>> before_;  // arcs to the vertices earlier in order_
+
+    double time_limit_ms_ = INFINITY;
+    long node_limit_ = 0;
+    long node_count_ = 0;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace gempp
+
+#endif // V2_SUBGRAPH_MATCHER_H
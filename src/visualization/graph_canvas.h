@@ -2,13 +2,14 @@
 #define GRAPH_CANVAS_H
 
 #include "../model/graph.h"
+#include "../solver/matching.h"
 #include <ftxui/dom/elements.hpp>
 #include <ftxui/screen/screen.hpp>
 #include <ftxui/screen/color.hpp>
 #include <iostream>
 #include <vector>
 #include <set>
-#include <map>
+#include <cmath>
 #include <string>
 #include <sstream>
 
@@ -16,48 +17,32 @@ namespace gempp {
 
 class GraphCanvas {
 public:
-    static void renderMatchingResult(Graph* pattern, Graph* target,
-                                     const std::vector<int>& unmatchedPatternVertices,
-                                     const std::vector<std::pair<int,int>>& unmatchedPatternEdges,
-                                     int ged, bool isSubgraph) {
+    // Minimal extension result: pattern, target, and the target extended by the unmatched
+    // pattern vertices and edges of the matching
+    static void renderMatchingResult(Graph* pattern, Graph* target, const Matching& matching) {
         using namespace ftxui;
 
+        double objective = matching.getObjective();
+        int ged = std::isinf(objective) ? -1 : static_cast<int>(std::round(objective));
+        bool isSubgraph = objective < 1e-6;
+        std::vector<int> unmatchedPatternVertices = matching.getUnmatchedPatternVertices();
+        std::vector<std::pair<int,int>> unmatchedPatternEdges = matching.getUnmatchedPatternArcs();
+
         int nP = pattern->getVertexCount();
         int nT = target->getVertexCount();
-        int eP = pattern->getEdgeCount();
-        int eT = target->getEdgeCount();
-
-        // Build adjacency matrices
-        std::vector<std::vector<int>> patternAdj(nP, std::vector<int>(nP, 0));
-        for (int i = 0; i < eP; ++i) {
-            Edge* edge = pattern->getEdge(i);
-            patternAdj[edge->getOrigin()->getIndex()][edge->getTarget()->getIndex()]++;
-        }
+        int eP = pattern->getTotalArcMultiplicity();
+        int eT = target->getTotalArcMultiplicity();
 
-        std::vector<std::vector<int>> targetAdj(nT, std::vector<int>(nT, 0));
-        for (int i = 0; i < eT; ++i) {
-            Edge* edge = target->getEdge(i);
-            targetAdj[edge->getOrigin()->getIndex()][edge->getTarget()->getIndex()]++;
-        }
+        // Build adjacency matrices (parallel edges counted individually, undirected symmetric)
+        std::vector<std::vector<int>> patternAdj = adjacencyMatrix(pattern);
+        std::vector<std::vector<int>> targetAdj = adjacencyMatrix(target);
 
-        // Create mapping from pattern vertices to solution vertices
-        // Matched pattern vertices map to their matched target vertices
-        // Unmatched pattern vertices get new indices at the end (nT, nT+1, ...)
-        std::map<int, int> patternToSolution;
-        
-        // For simplicity, assume matched pattern vertices map to same index in target
-        // (this is a simplification - in reality we'd need the actual matching)
-        // Unmatched vertices get new indices
+        // Solution vertex of each pattern vertex: its matched target vertex, or a new vertex
+        // appended after the target ones (nT, nT+1, ...) if unmatched
+        std::vector<int> patternToSolution(matching.getTargetVertices());
         int nextNewIndex = nT;
-        std::set<int> unmatchedSet(unmatchedPatternVertices.begin(), unmatchedPatternVertices.end());
-        
         for (int i = 0; i < nP; ++i) {
-            if (unmatchedSet.count(i)) {
-                patternToSolution[i] = nextNewIndex++;
-            } else {
-                // Matched - for now assume identity mapping for matched vertices
-                patternToSolution[i] = i;
-            }
+            if (patternToSolution[i] < 0) patternToSolution[i] = nextNewIndex++;
         }
 
         // Build solution (target + new vertices at the end)
@@ -101,7 +86,8 @@ public:
 
         // Create result card
         Elements resultContent;
-        resultContent.push_back(hbox({text("GED:             "), text(std::to_string(ged)) | bold}));
+        resultContent.push_back(hbox({text("GED:             "), text(std::to_string(ged)) | bold,
+                                      text(matching.getBoundNote())}));
         resultContent.push_back(hbox({text("Is Subgraph:     "), text(isSubgraph ? "yes" : "no")}));
         resultContent.push_back(hbox({text("Vertices to add: "), text(std::to_string(unmatchedPatternVertices.size()))}));
         resultContent.push_back(hbox({text("Edges to add:    "), text(std::to_string(unmatchedPatternEdges.size()))}));
@@ -152,6 +138,20 @@ public:
     }
 
 private:
+    static std::vector<std::vector<int>> adjacencyMatrix(const Graph* g) {
+        int n = g->getVertexCount();
+        std::vector<std::vector<int>> adj(n, std::vector<int>(n, 0));
+        for (int e = 0; e < g->getEdgeCount(); ++e) {
+            int o = g->getOrigin(e);
+            int t = g->getTarget(e);
+            adj[o][t] += g->getMultiplicity(e);
+            if (!g->isDirected() && o != t) {
+                adj[t][o] += g->getMultiplicity(e);
+            }
+        }
+        return adj;
+    }
+
     static ftxui::Element createGraphCard(const std::string& title,
                                            const std::vector<std::vector<int>>& adj,
                                            int vertexCount, int edgeCount,